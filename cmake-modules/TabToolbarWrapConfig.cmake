@@ -0,0 +1,40 @@
+# tt_wrap_config(<outfiles> config1.json [config2.json ...] [OPTIONS ...])
+#
+# Compiles TabToolbar json configs with ttc into headers named tt_<config>.h,
+# which are placed into current binary directory and appended to <outfiles>,
+# the same way qt5_wrap_ui does with .ui files. Extra ttc arguments (e.g. -n <name>)
+# can be passed after OPTIONS.
+
+include(CMakeParseArguments)
+
+function(tt_wrap_config outfiles)
+    cmake_parse_arguments(_WRAP "" "" "OPTIONS" ${ARGN})
+
+    if(TARGET ttc)
+        set(_ttc_executable $<TARGET_FILE:ttc>)
+        set(_ttc_depends ttc)
+    else()
+        find_program(TT_TTC_EXECUTABLE ttc
+                     PATH_SUFFIXES bin
+                     PATHS ${TabToolbar_ROOT} $ENV{TabToolbar_ROOT})
+        if(NOT TT_TTC_EXECUTABLE)
+            message(FATAL_ERROR "tt_wrap_config: could not find ttc executable")
+        endif()
+        set(_ttc_executable ${TT_TTC_EXECUTABLE})
+        set(_ttc_depends "")
+    endif()
+
+    foreach(it ${_WRAP_UNPARSED_ARGUMENTS})
+        get_filename_component(outfile ${it} NAME_WE)
+        get_filename_component(infile ${it} ABSOLUTE)
+        set(outfile ${CMAKE_CURRENT_BINARY_DIR}/tt_${outfile}.h)
+        add_custom_command(OUTPUT ${outfile}
+                           COMMAND ${_ttc_executable} ${_WRAP_OPTIONS} -o ${outfile} ${infile}
+                           MAIN_DEPENDENCY ${infile}
+                           DEPENDS ${_ttc_depends}
+                           VERBATIM)
+        set_source_files_properties(${outfile} PROPERTIES SKIP_AUTOMOC ON)
+        list(APPEND ${outfiles} ${outfile})
+    endforeach()
+    set(${outfiles} ${${outfiles}} PARENT_SCOPE)
+endfunction()
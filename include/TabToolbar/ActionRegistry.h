@@ -0,0 +1,56 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_ACTION_REGISTRY_H
+#define TT_ACTION_REGISTRY_H
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QString>
+#include <QAction>
+#include <QMenu>
+#include <TabToolbar/API.h>
+
+namespace tt
+{
+
+//Name index of actions and menus, which Builder resolves config entries against.
+//Registered objects are found by a single hash lookup. Search roots are walked
+//only on the first miss, once per root, and never beyond their own subtree.
+class TT_API ActionRegistry
+{
+public:
+    void     AddAction(QAction* action);
+    void     AddAction(const QString& name, QAction* action);
+    void     AddMenu(QMenu* menu);
+    void     AddMenu(const QString& name, QMenu* menu);
+    void     AddSearchRoot(QObject* root);
+
+    QAction* FindAction(const QString& name) const;
+    QMenu*   FindMenu(const QString& name) const;
+
+private:
+    void     IndexSearchRoots() const;
+
+    mutable QHash<QString, QPointer<QAction>> actions;
+    mutable QHash<QString, QPointer<QMenu>>   menus;
+    QList<QPointer<QObject>>                  searchRoots;
+    mutable int                               indexedRoots = 0;
+};
+
+}
+#endif
@@ -21,33 +21,94 @@
 #include <QString>
 #include <QAction>
 #include <QMenu>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
 #include <QMap>
+#include <QPointer>
 #include <QWidget>
 #include <functional>
 #include <TabToolbar/API.h>
+#include <TabToolbar/ActionRegistry.h>
+#include <TabToolbar/ToolbarConfig.h>
+#include <TabToolbar/ToolbarModel.h>
 
+class QFileSystemWatcher;
 class QJsonObject;
 
 namespace tt
 {
 
 class TabToolbar;
+class Page;
+
+//Config parsed and its icons decoded away from GUI thread, Builder only has to create widgets from it
+struct TT_API PreparedConfig
+{
+    ToolbarConfig          config;
+    QHash<QString, QImage> icons; //by icon path
+    QString                error; //not empty if config could not be loaded
+};
+
+struct TT_API ConfigCacheStats
+{
+    unsigned hits = 0;
+    unsigned misses = 0;
+};
+
+using TConfigCacheHook = std::function<void(const QString& configPath, bool hit)>;
+
+TT_API PreparedConfig          PrepareConfig(const QString& configPath);
+TT_API QFuture<PreparedConfig> PrepareConfigAsync(const QString& configPath);
+
+//Configs loaded by path are parsed once per process and reused until file changes
+TT_API ConfigCacheStats        GetConfigCacheStats();
+TT_API void                    SetConfigCacheHook(const TConfigCacheHook& hook);
+TT_API void                    ClearConfigCache();
 
 class TT_API Builder : public QObject
 {
     Q_OBJECT
 public:
     explicit Builder(QWidget* parent);
+    Builder(QWidget* parent, const ActionRegistry& registry);
 
     TabToolbar* CreateTabToolbar(const QString& configPath);
+    TabToolbar* CreateTabToolbar(const uchar* data, qint64 size);
+    TabToolbar* CreateTabToolbar(const ToolbarConfig& config);
+    TabToolbar* CreateTabToolbar(const PreparedConfig& prepared);
+    TabToolbar* CreateTabToolbar(ToolbarModel& model); //toolbar follows model changes
+    //Builds current page right away and the rest in slices of sliceMs from event loop,
+    //see TabToolbar::MaterializeProgress
+    TabToolbar* CreateTabToolbarAsync(const QString& configPath, int sliceMs = 8);
+    TabToolbar* CreateTabToolbarAsync(const ToolbarConfig& config, int sliceMs = 8);
     void        SetCustomWidgetCreator(const QString& name, const std::function<QWidget*()>& creator);
     void        SetCustomWidgetCreator(const QString& name, const std::function<QWidget*(const QJsonObject&)>& creator);
+    void        SetLazyPageConstruction(bool lazy);
+
+    //Applies changes of config file to the model, toolbars created from it update only what has changed.
+    //File is always read anew, bypassing (and refreshing) the config cache
+    void        ReloadConfig(ToolbarModel& model, const QString& configPath);
+    void        WatchConfig(ToolbarModel& model, const QString& configPath);
 
     QWidget*    operator[](const QString& widgetName) const;
 
+signals:
+    void        ConfigReloadFailed(const QString& configPath, const QString& error);
+
 private:
-    QMap<QString, QWidget*> guiWidgets;
+    TabToolbar* CreateTabToolbar(const ToolbarConfig& config, const QHash<QString, QImage>& icons,
+                                 ToolbarModel* model = nullptr);
+    void        ConfigFileChanged(const QString& configPath);
+    TabToolbar* CreateInSlices(const std::function<TabToolbar*()>& create, int sliceMs);
+
+    ActionRegistry          registry;
+    QMap<QString, QPointer<QWidget>> guiWidgets;
+    QMap<QString, QPointer<Page>> deferredWidgets;
     QMap<QString, std::function<QWidget*(const QJsonObject&)>> customWidgetCreators;
+    bool lazyPages = false;
+    QFileSystemWatcher* watcher = nullptr;
+    QMap<QString, QPointer<ToolbarModel>> watchedModels;
 };
 
 }
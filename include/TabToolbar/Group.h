@@ -21,31 +21,54 @@
 #include <QString>
 #include <QToolButton>
 #include <QHBoxLayout>
+#include <QPointer>
 #include <QVariant>
+#include <memory>
 #include <TabToolbar/API.h>
 #include <TabToolbar/SubGroup.h>
 
 class QAction;
+class QLabel;
 class QMenu;
 
 namespace tt
 {
+class Page;
+struct ToolbarContext;
 
 class TT_API Group : public QFrame
 {
     Q_OBJECT
 public:
     explicit Group(const QString& name, QWidget* parent = nullptr);
+    Group(const QString& name, const std::shared_ptr<ToolbarContext>& context, QWidget* parent = nullptr);
 
     void        AddAction(QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu = nullptr);
     void        AddSeparator();
     SubGroup*   AddSubGroup(SubGroup::Align align);
     void        AddWidget(QWidget* widget);
 
+    //index is position among group items, -1 appends
+    void        InsertAction(int index, QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu = nullptr);
+    void        InsertSeparator(int index);
+    SubGroup*   InsertSubGroup(int index, SubGroup::Align align);
+    void        InsertWidget(int index, QWidget* widget);
+    void        RemoveItem(int index);
+    int         ItemCount() const;
+
 private:
     QFrame*     CreateSeparator();
+    void        SetContext(const std::shared_ptr<ToolbarContext>& newContext);
+    void        SetOwner(Page* page);
+    void        ApplyContext();
+    void        UpdateHeight();
 
     QHBoxLayout* innerLayout;
+    QLabel*      groupName;
+    std::shared_ptr<ToolbarContext> context;
+    QPointer<Page> owner; //page group was inserted into, it is pinned by changes made outside of its creators
+
+    friend class Page;
 };
 
 }
@@ -20,23 +20,47 @@
 #include <QWidget>
 #include <QString>
 #include <memory>
+#include <functional>
+#include <vector>
 #include <TabToolbar/API.h>
 
 class QHBoxLayout;
+class QScrollArea;
 
 namespace tt
 {
 class TabToolbar;
 class Group;
+struct ToolbarContext;
 
 class TT_API Page : public QWidget
 {
     Q_OBJECT
 public:
+    using TGroupCreator = std::function<void(Page&)>;
+
     explicit Page(int index, const QString& pageName, QWidget* parent = nullptr);
     virtual ~Page() = default;
 
     Group*   AddGroup(const QString& name);
+    Group*   AddGroup(Group* group);
+    Group*   InsertGroup(int index, const QString& name); //-1 appends
+    Group*   InsertGroup(int index, Group* group);
+    void     RemoveGroup(int index);
+    void     AddDeferredGroup(const TGroupCreator& creator);
+    Group*   GetGroup(int index) const;
+    int      GroupCount() const;
+    bool     IsMaterialized() const;
+    void     Materialize();
+    bool     MaterializeNext();
+    int      Id() const; //reused by later pages once this one is deleted
+    bool     CanHibernate() const;
+    void     Pin(); //keeps page from hibernation, e.g. while its widgets are used elsewhere
+    bool     IsPinned() const;
+    void     ApplyCreatorChange(const std::function<void()>& change); //creators reproduce it on rebuild, page is not pinned
+    bool     Hibernate();
+    void     Rebuild();
+    std::size_t EstimateMemoryUsage() const;
     void     hide();
     void     show();
 
@@ -45,9 +69,23 @@ signals:
     void     Showing(int index);
 
 private:
+    const std::shared_ptr<ToolbarContext>& Context();
+    int      ApplyContext();
+    void     GroupChanged();
+
     const int    myIndex;
     QHBoxLayout* innerLayout;
     QWidget*     innerArea;
+    QScrollArea* scrollArea;
+    std::vector<TGroupCreator> deferredGroups;
+    std::size_t  builtGroups = 0;
+    bool         pinned = false;
+    bool         materializing = false;
+    std::shared_ptr<ToolbarContext> context;
+
+    friend class TabToolbar;
+    friend class Group;
+    friend class SubGroup;
 };
 
 }
@@ -24,11 +24,35 @@
 #include <TabToolbar/API.h>
 #include <TabToolbar/Styles.h>
 
+class QScreen;
+
 namespace tt
 {
 	
 using TStyleCreator = std::function<StyleParams*()>;
 
+struct TT_API CachedStyle
+{
+    std::shared_ptr<const StyleParams> params;
+    QString                            sheet;
+};
+
+struct TT_API StyleCacheStats
+{
+    unsigned hits = 0;
+    unsigned misses = 0;
+};
+
+struct TT_API IconCacheStats
+{
+    unsigned hits = 0;
+    unsigned misses = 0;
+    unsigned evictions = 0;
+    int      count = 0;
+    int      bytes = 0;
+    int      limit = 0;
+};
+
 TT_API void                         RegisterStyle(const QString& styleName, const TStyleCreator& creator);
 TT_API void                         UnregisterStyle(const QString& styleName);
 TT_API bool                         IsStyleRegistered(const QString& styleName);
@@ -37,7 +61,21 @@ TT_API QStringList                  GetRegisteredStyles();
 TT_API std::unique_ptr<StyleParams> CreateStyle(const QString& styleName);
 TT_API QString                      GetDefaultStyle();
 
+//Styles and their sheets are cached per style name and current application palette
+TT_API CachedStyle                  GetCachedStyle(const QString& styleName);
+TT_API QString                      GetCachedSheetForStyle(const QString& styleName);
+TT_API uint                         GetPaletteFingerprint();
+TT_API StyleCacheStats              GetStyleCacheStats();
+TT_API void                         ClearStyleCache();
+
+//Pixmaps of toolbar button icons are cached, limit is in bytes (4 MB by default)
+TT_API void                         SetIconCacheLimit(int bytes);
+TT_API IconCacheStats               GetIconCacheStats();
+TT_API void                         ClearIconCache();
+
+QString                             GetSheetForProperty(const QString& sheet, const QString& property);
 float                               GetScaleFactor(const QWidget& widget);
+float                               GetScaleFactor(const QScreen& screen);
 int                                 GetPixelMetric(QStyle::PixelMetric metric);
 
 }
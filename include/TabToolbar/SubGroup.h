@@ -22,9 +22,11 @@
 #include <QPixmap>
 #include <QToolButton>
 #include <QVBoxLayout>
+#include <QPointer>
 #include <QHBoxLayout>
 #include <QApplication>
 #include <QStyle>
+#include <memory>
 #include <vector>
 #include <TabToolbar/API.h>
 
@@ -33,6 +35,9 @@ class QMenu;
 
 namespace tt
 {
+class ButtonStrip;
+class Page;
+struct ToolbarContext;
 
 class TT_API SubGroup : public QFrame
 {
@@ -52,6 +57,7 @@ public:
     };
 
     SubGroup(Align align, QWidget* parent = nullptr);
+    SubGroup(Align align, const std::shared_ptr<ToolbarContext>& context, QWidget* parent = nullptr);
 
     void       AddAction(QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu = nullptr);
     void       AddHorizontalButtons(const std::vector<ActionParams>& params);
@@ -59,8 +65,14 @@ public:
 
 private:
     QFrame*    ConstructInnerFrame(int spacing);
+    ButtonStrip* PaintedRows();
+    void       SetContext(const std::shared_ptr<ToolbarContext>& newContext);
 
     QVBoxLayout* innerLayout;
+    std::shared_ptr<ToolbarContext> context;
+    QPointer<Page> owner; //page of parent group
+
+    friend class Group;
 };
 
 }
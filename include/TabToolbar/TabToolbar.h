@@ -19,43 +19,91 @@
 #define TAB_TOOLBAR_H
 #include <QTabWidget>
 #include <QToolBar>
+#include <QColor>
+#include <QHash>
 #include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QSet>
+#include <QStringList>
 #include <QTimer>
+#include <QVector>
+#include <functional>
 #include <memory>
+#include <vector>
 #include <TabToolbar/API.h>
 
 class QToolButton;
 class QFrame;
 class QMenu;
+class QScreen;
+class QWindow;
 
 namespace tt
 {
 class Page;
 class StyleParams;
+class TTNativeStyle;
+class TTToolButtonStyle;
+struct ToolbarContext;
 
 class TT_API TabToolbar : public QToolBar
 {
     Q_OBJECT
 public:
+    enum class RenderMode
+    {
+        StyleSheet,       //style is applied as a style sheet to whole toolbar
+        ScopedStyleSheet, //style sheet is applied to library leaf widgets only, containers are painted natively
+        Native            //library widgets are painted by a proxy style, no style sheets involved
+    };
+
     explicit TabToolbar(QWidget* parent = nullptr, unsigned _groupMaxHeight = 75, unsigned _groupRowCount = 3);
     virtual ~TabToolbar();
 
     void     SetSpecialTabEnabled(bool enabled);
+    void     SetMinimizedPopupEnabled(bool enabled);
+    bool     IsMinimizedPopupEnabled() const;
+    void     SetHibernationLimit(int alivePages);
+    int      HibernationLimit() const;
+    void     SetPaintedButtons(bool painted); //affects groups built afterwards
+    bool     PaintedButtons() const;
+    void     MaterializeAsync(int sliceMs = 8);
+    bool     IsMaterializing() const;
     Page*    AddPage(const QString& pageName);
+    Page*    AddPage(const QString& pageName, const QString& contextName);
+    Page*    InsertPage(Page* before, const QString& pageName); //appends when before is null
+    Page*    InsertPage(Page* before, const QString& pageName, const QString& contextName);
+    void     AddContext(const QString& contextName, const QColor& color = QColor());
+    void     SetActiveContexts(const QStringList& contextNames);
+    QStringList ActiveContexts() const;
+    Page*    GetPage(int id) const;
+    bool     IsPageVisible(int id) const;
+    void     SetPageVisible(int id, bool visible);
+    void     SetPagesVisible(const QSet<int>& ids, bool visible);
     QAction* HideAction();
     void     AddCornerAction(QAction* action);
     void     SetStyle(const QString& styleName);
     QString  GetStyle() const;
+    void     SetRenderMode(RenderMode mode);
+    RenderMode GetRenderMode() const;
+    unsigned SkippedRestyles() const; //style and palette changes that did not regenerate style
     unsigned RowCount() const;
     unsigned GroupMaxHeight() const;
+    std::shared_ptr<ToolbarContext> Context() const;
     int      CurrentTab() const;
     void     SetCurrentTab(int index);
+    Page*    CurrentPage() const;
+    void     SetCurrentPage(Page* page);
+    void     BeginUpdate();
+    void     EndUpdate();
 
 signals:
     void     Minimized();
     void     Maximized();
     void     SpecialTabClicked();
     void     StyleChanged();
+    void     MaterializeProgress(int builtGroups, int totalGroups);
 
 private slots:
     void     FocusChanged(QWidget* old, QWidget* now);
@@ -67,9 +115,37 @@ private slots:
 
 protected:
     bool     event(QEvent* event) override;
+    bool     eventFilter(QObject* watched, QEvent* event) override;
 
 private:
     void     AdjustVerticalSize(unsigned vSize);
+    void     ScheduleVerticalSizeUpdate();
+    void     ApplyMaxHeight();
+    void     ApplyRenderMode(QWidget* root, bool repolish);
+    void     UpdateScopedSheets(const QString& sheet);
+    void     UpdateBaseStyles();
+    void     ScheduleRestyle();
+    void     Restyle();
+    void     UpdateContext();
+    void     WatchScreen();
+    void     ScreenChanged(QScreen* screen);
+    void     Rescale();
+    void     ShowPopup(int index);
+    int      PopupHeight() const;
+    void     RestorePopupContent();
+    void     TouchPage(Page* page);
+    bool     ApplyPageVisibility(int id, bool visible);
+    void     ApplyPagesBatch(const std::function<void()>& apply);
+    void     ApplyContextColor(int id, int position);
+    void     UpdateVisiblePages(int id, int delta);
+    int      VisiblePagesBefore(int id) const;
+    int      VisibleBeforePosition(std::size_t position) const;
+    void     InsertPageOrder(int id, int position);
+    void     RebuildVisiblePages();
+    void     ReleasePage(int id);
+    void     EnforceHibernationLimit();
+    void     MaterializeSlice();
+    void     UpdateFocusTracking();
 
     const unsigned groupRowCount;
     const unsigned groupMaxHeight;
@@ -84,12 +160,72 @@ private:
     bool           ignoreStyleEvent = false;
     bool           isMinimized = false;
     bool           isShown = true;
+    bool           minimizedPopup = false;
+    bool           ignoreTabClick = false;
+    QFrame*        popup = nullptr;
+    QPointer<Page> popupPage;
+    int            hibernationLimit = 0;
+    QList<QPointer<Page>> recentPages;
+    QList<QPointer<Page>> materializeQueue;
+    QTimer         materializeTimer;
+    int            materializeSliceMs = 8;
+    std::vector<QPointer<Page>> pages;       //indexed by page id
+    std::vector<char>   pageVisible;
+    std::vector<int>    pageOrder;           //page ids in tab order
+    std::vector<int>    pagePositions;       //index in pageOrder by page id
+    std::vector<int>    visiblePagesTree{0}; //1-based Fenwick tree over pageVisible in tab order
+    std::vector<int>    pageContexts;        //index in tabContexts or -1
+    std::vector<int>    freePageIds;         //ids of deleted pages, reused by next ones
+    struct TabContext
+    {
+        QString      name;
+        QColor       color;
+        QVector<int> pages;
+        bool         active = false;
+    };
+    QVector<TabContext> tabContexts;
+    QHash<QString, int> tabContextIndices;
     QTimer         tempShowTimer;
-    std::unique_ptr<StyleParams> style;
+    QTimer         restyleTimer;
+    uint           paletteFingerprint = 0;
+    unsigned       skippedRestyles = 0;
+    int            updateDepth = 0;
+    unsigned       pendingGroupHeight = 0;
+    bool           verticalSizeScheduled = false;
+    std::shared_ptr<const StyleParams> style;
+    RenderMode     renderMode = RenderMode::StyleSheet;
+    std::unique_ptr<TTNativeStyle> nativeStyle;
+    QMap<QString, QString> scopedSheets;
+    std::shared_ptr<TTToolButtonStyle> buttonStyle;
+    std::shared_ptr<ToolbarContext> context;
+    QPointer<QWindow> watchedWindow;
+    QMetaObject::Connection screenDpiConnection;
+    QMetaObject::Connection focusConnection;
 
     friend class Page;
 };
 
+//Batches toolbar construction between BeginUpdate and EndUpdate for the lifetime of a scope
+class TabToolbarUpdateGuard
+{
+public:
+    explicit TabToolbarUpdateGuard(TabToolbar* tabToolbar) : toolbar(tabToolbar)
+    {
+        if(toolbar)
+            toolbar->BeginUpdate();
+    }
+    ~TabToolbarUpdateGuard()
+    {
+        if(toolbar)
+            toolbar->EndUpdate();
+    }
+    TabToolbarUpdateGuard(const TabToolbarUpdateGuard&) = delete;
+    TabToolbarUpdateGuard& operator=(const TabToolbarUpdateGuard&) = delete;
+
+private:
+    QPointer<TabToolbar> toolbar;
+};
+
 TabToolbar* _FindTabToolbarParent(QWidget& startingWidget);
 
 }
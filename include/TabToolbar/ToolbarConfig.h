@@ -0,0 +1,120 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_TOOLBAR_CONFIG_H
+#define TT_TOOLBAR_CONFIG_H
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QToolButton>
+#include <QVector>
+#include <TabToolbar/API.h>
+
+namespace tt
+{
+
+//Parsed and validated form of tabtoolbar json config.
+//Builder instantiates widgets from it, it can also be stored in compact binary form.
+
+struct TT_API ActionConfig
+{
+    QToolButton::ToolButtonPopupMode type = QToolButton::DelayedPopup;
+    QString                          name;
+    QString                          menu;
+    QString                          icon; //optional image path, Builder sets it on actions which have no icon yet
+};
+
+struct TT_API ItemConfig
+{
+    enum class Type
+    {
+        Action,
+        SubGroup,
+        Separator,
+        HorizontalActions,
+        Custom
+    };
+
+    Type                  type = Type::Separator;
+    QString               name;
+    QString               customType;
+    QJsonObject           properties; //original json of custom item, passed to its creator
+    bool                  aligned = false;
+    ActionConfig          action;
+    QVector<ActionConfig> actions;
+    QVector<ItemConfig>   content;
+};
+
+struct TT_API GroupConfig
+{
+    QString             name;
+    QString             displayName;
+    QVector<ItemConfig> content;
+};
+
+struct TT_API TabConfig
+{
+    QString              name;
+    QString              displayName;
+    QString              context; //contextual tab set this tab belongs to, empty for ordinary tabs
+    QVector<GroupConfig> groups;
+};
+
+struct TT_API MenuConfig
+{
+    QString     name;
+    QStringList actions;
+};
+
+struct TT_API ContextConfig
+{
+    QString name;
+    QString color; //anything QColor accepts, empty for default tab color
+};
+
+struct TT_API ToolbarConfig
+{
+    int                 groupHeight = 0;
+    int                 groupRowCount = 0;
+    bool                specialTab = false;
+    bool                paintedButtons = false;
+    QStringList         cornerActions;
+    QVector<MenuConfig>    menus;
+    QVector<ContextConfig> contexts;
+    QVector<TabConfig>     tabs;
+};
+
+TT_API bool operator==(const ActionConfig& left, const ActionConfig& right);
+TT_API bool operator==(const ItemConfig& left, const ItemConfig& right);
+TT_API bool operator==(const GroupConfig& left, const GroupConfig& right);
+TT_API bool operator==(const TabConfig& left, const TabConfig& right);
+inline bool operator!=(const ActionConfig& left, const ActionConfig& right) { return !(left == right); }
+inline bool operator!=(const ItemConfig& left, const ItemConfig& right) { return !(left == right); }
+inline bool operator!=(const GroupConfig& left, const GroupConfig& right) { return !(left == right); }
+inline bool operator!=(const TabConfig& left, const TabConfig& right) { return !(left == right); }
+
+TT_API ToolbarConfig ParseConfig(const QJsonObject& root);
+TT_API QJsonObject   ConfigToJson(const ToolbarConfig& config);
+TT_API QMap<QString, QString> CollectActionIcons(const ToolbarConfig& config); //action name -> icon path
+TT_API QByteArray    ConfigToBinary(const ToolbarConfig& config);
+TT_API bool          IsBinaryConfig(const uchar* data, qint64 size);
+TT_API ToolbarConfig ParseBinaryConfig(const uchar* data, qint64 size);
+
+}
+#endif
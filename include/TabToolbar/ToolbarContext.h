@@ -0,0 +1,51 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+    Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_TOOLBAR_CONTEXT_H
+#define TT_TOOLBAR_CONTEXT_H
+#include <QFrame>
+#include <QPointer>
+#include <QToolButton>
+#include <QWidget>
+#include <memory>
+#include <TabToolbar/API.h>
+
+namespace tt
+{
+class TabToolbar;
+class TTToolButtonStyle;
+
+//Owning toolbar and its layout metrics, handed down Page -> Group -> SubGroup on construction.
+//Toolbar keeps it up to date in place, groups built without toolbar get a default one.
+struct TT_API ToolbarContext
+{
+    QPointer<TabToolbar>               toolbar;
+    unsigned                           groupMaxHeight = 75; //scaled
+    unsigned                           rowCount = 3;
+    float                              scaleFactor = 1.0f;
+    std::shared_ptr<TTToolButtonStyle> buttonStyle;
+    bool                               paintedButtons = false; //groups paint their buttons instead of creating widgets
+    QPointer<QToolButton>              largeButtonProxy;       //hidden buttons painted ones take style and sheet rules from
+    QPointer<QToolButton>              smallButtonProxy;
+    QPointer<QFrame>                   horizontalFrameProxy;   //frame painted around rows of horizontal buttons
+};
+
+TT_API std::shared_ptr<ToolbarContext> CreateDefaultToolbarContext();
+TT_API std::shared_ptr<ToolbarContext> FindToolbarContext(QWidget* widget);
+
+}
+#endif
@@ -0,0 +1,72 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_TOOLBAR_MODEL_H
+#define TT_TOOLBAR_MODEL_H
+#include <QObject>
+#include <TabToolbar/API.h>
+#include <TabToolbar/ToolbarConfig.h>
+
+namespace tt
+{
+
+//Toolbar description shared by any number of TabToolbar views (see Builder::CreateTabToolbar),
+//views hold only widgets and follow changes reported by signals below.
+//Heights and corner actions are applied when view is created, menus and contexts new to the model
+//are passed on to views before any tab refers to them.
+
+class TT_API ToolbarModel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ToolbarModel(QObject* parent = nullptr);
+    explicit ToolbarModel(const ToolbarConfig& config, QObject* parent = nullptr);
+
+    const ToolbarConfig& Config() const;
+    void     Reset(const ToolbarConfig& newConfig);
+    void     Update(const ToolbarConfig& newConfig); //applies only the difference, tabs and groups are matched by name
+
+    void     InsertTab(int tabIndex, const TabConfig& tab);
+    void     RemoveTab(int tabIndex);
+    void     InsertGroup(int tabIndex, int groupIndex, const GroupConfig& group);
+    void     RemoveGroup(int tabIndex, int groupIndex);
+    void     InsertItem(int tabIndex, int groupIndex, int itemIndex, const ItemConfig& item);
+    void     RemoveItem(int tabIndex, int groupIndex, int itemIndex);
+    void     SetItem(int tabIndex, int groupIndex, int itemIndex, const ItemConfig& item);
+
+signals:
+    void     ModelReset();
+    void     SettingsChanged(); //toolbar-wide part of config was replaced by Update
+    void     TabInserted(int tabIndex);
+    void     TabRemoved(int tabIndex);
+    void     GroupInserted(int tabIndex, int groupIndex);
+    void     GroupRemoved(int tabIndex, int groupIndex);
+    void     ItemInserted(int tabIndex, int groupIndex, int itemIndex);
+    void     ItemRemoved(int tabIndex, int groupIndex, int itemIndex);
+    void     ItemChanged(int tabIndex, int groupIndex, int itemIndex);
+
+private:
+    TabConfig&   TabAt(int tabIndex);
+    GroupConfig& GroupAt(int tabIndex, int groupIndex);
+    void     UpdateGroups(int tabIndex, const QVector<GroupConfig>& groups);
+    void     UpdateItems(int tabIndex, int groupIndex, const QVector<ItemConfig>& items);
+
+    ToolbarConfig config;
+};
+
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <TabToolbar/ActionRegistry.h>
+
+using namespace tt;
+
+void ActionRegistry::AddAction(QAction* action)
+{
+    AddAction(action->objectName(), action);
+}
+
+void ActionRegistry::AddAction(const QString& name, QAction* action)
+{
+    actions.insert(name, action);
+}
+
+void ActionRegistry::AddMenu(QMenu* menu)
+{
+    AddMenu(menu->objectName(), menu);
+}
+
+void ActionRegistry::AddMenu(const QString& name, QMenu* menu)
+{
+    menus.insert(name, menu);
+}
+
+void ActionRegistry::AddSearchRoot(QObject* root)
+{
+    searchRoots.append(root);
+}
+
+QAction* ActionRegistry::FindAction(const QString& name) const
+{
+    QAction* action = actions.value(name);
+    if(!action && indexedRoots < searchRoots.size())
+    {
+        IndexSearchRoots();
+        action = actions.value(name);
+    }
+    return action;
+}
+
+QMenu* ActionRegistry::FindMenu(const QString& name) const
+{
+    QMenu* menu = menus.value(name);
+    if(!menu && indexedRoots < searchRoots.size())
+    {
+        IndexSearchRoots();
+        menu = menus.value(name);
+    }
+    return menu;
+}
+
+void ActionRegistry::IndexSearchRoots() const
+{
+    for(; indexedRoots < searchRoots.size(); indexedRoots++)
+    {
+        QObject* root = searchRoots.at(indexedRoots);
+        if(!root)
+            continue;
+
+        for(QAction* action : root->findChildren<QAction*>())
+            if(!actions.value(action->objectName()))
+                actions.insert(action->objectName(), action);
+        for(QMenu* menu : root->findChildren<QMenu*>())
+            if(!menus.value(menu->objectName()))
+                menus.insert(menu->objectName(), menu);
+    }
+}
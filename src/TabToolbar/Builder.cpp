@@ -16,29 +16,574 @@
     along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <QJsonDocument>
-#include <QJsonArray>
 #include <QJsonObject>
-#include <QJsonValue>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QResource>
+#include <QIcon>
+#include <QJsonParseError>
+#include <QPixmap>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QMap>
+#include <QSet>
 #include <QByteArray>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 #include <TabToolbar/Builder.h>
 #include <TabToolbar/TabToolbar.h>
 #include <TabToolbar/Page.h>
 #include <TabToolbar/Group.h>
 #include <TabToolbar/SubGroup.h>
+#include <TabToolbar/ToolbarModel.h>
 
 using namespace tt;
 
+namespace
+{
+using TCustomWidgetCreator = std::function<QWidget*(const QJsonObject&)>;
+
+struct BuildContext
+{
+    TabToolbar* tabToolbar;
+    ActionRegistry registry;
+    QMap<QString, TCustomWidgetCreator> customWidgetCreators;
+    std::function<void(const QString&, QWidget*)> registerWidget;
+    std::function<void(const QString&, Page*)>    registerDeferred; //widget is built with given page
+};
+
+QAction* FindAction(const ActionRegistry& registry, const QString& name)
+{
+    QAction* action = registry.FindAction(name);
+    if(!action)
+        throw std::logic_error(std::string("Unknown action: ") + name.toStdString());
+    return action;
+}
+
+ToolbarConfig ParseConfigData(const uchar* data, qint64 size)
+{
+    if(IsBinaryConfig(data, size))
+        return ParseBinaryConfig(data, size);
+
+    const QByteArray json = QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(size));
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if(parseError.error != QJsonParseError::NoError)
+        throw std::runtime_error("TabToolbar config is not valid json: " + parseError.errorString().toStdString());
+    return ParseConfig(document.object());
+}
+
+struct ConfigCache
+{
+    struct Entry
+    {
+        QString       stamp;
+        ToolbarConfig config;
+    };
+
+    QMutex                mutex;
+    QHash<QString, Entry> entries;
+    ConfigCacheStats      stats;
+    TConfigCacheHook      hook;
+};
+
+ConfigCache& GetConfigCache()
+{
+    static ConfigCache cache;
+    return cache;
+}
+
+// identifies file contents without reading them
+QString ConfigStamp(const QString& configPath)
+{
+    if(configPath.startsWith(':'))
+    {
+        // resource data lives in the binary and only moves when resources are re-registered
+        const QResource resource(configPath);
+        if(!resource.isValid())
+            return QString();
+        return QString("res:%1:%2").arg(quintptr(resource.data())).arg(resource.size());
+    }
+
+    const QFileInfo info(configPath);
+    if(!info.exists())
+        return QString();
+    return QString("file:%1:%2").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+}
+
+ToolbarConfig ReadConfig(const QString& configPath)
+{
+    QFile configFile(configPath);
+    if(!configFile.open(QIODevice::ReadOnly))
+        throw std::runtime_error(configPath.toStdString() + " - could not open config file!");
+
+    const qint64 size = configFile.size();
+    if(const uchar* data = configFile.map(0, size))
+        return ParseConfigData(data, size);
+
+    const QByteArray content = configFile.readAll();
+    return ParseConfigData(reinterpret_cast<const uchar*>(content.constData()), content.size());
+}
+
+void StoreConfig(const QString& key, const QString& stamp, const ToolbarConfig& config)
+{
+    ConfigCache& cache = GetConfigCache();
+    QMutexLocker lock(&cache.mutex);
+    if(stamp.isEmpty())
+        cache.entries.remove(key);
+    else
+        cache.entries.insert(key, ConfigCache::Entry{stamp, config});
+}
+
+ToolbarConfig LoadConfig(const QString& configPath)
+{
+    ConfigCache& cache = GetConfigCache();
+    const QString key = QFileInfo(configPath).absoluteFilePath();
+    const QString stamp = ConfigStamp(configPath);
+    TConfigCacheHook hook;
+    {
+        QMutexLocker lock(&cache.mutex);
+        hook = cache.hook;
+        auto it = cache.entries.constFind(key);
+        if(!stamp.isEmpty() && it != cache.entries.constEnd() && it->stamp == stamp)
+        {
+            cache.stats.hits++;
+            const ToolbarConfig config = it->config;
+            lock.unlock();
+            if(hook)
+                hook(configPath, true);
+            return config;
+        }
+        cache.stats.misses++;
+    }
+    if(hook)
+        hook(configPath, false);
+
+    // parsing is done unlocked, concurrent loads of the same new config simply race to store it
+    const ToolbarConfig config = ReadConfig(configPath);
+    StoreConfig(key, stamp, config);
+    return config;
+}
+
+// file was reported changed, yet an edit within one mtime tick keeping its size leaves the stamp as is
+ToolbarConfig LoadChangedConfig(const QString& configPath)
+{
+    const QString stamp = ConfigStamp(configPath);
+    const ToolbarConfig config = ReadConfig(configPath);
+    StoreConfig(QFileInfo(configPath).absoluteFilePath(), stamp, config);
+    return config;
+}
+
+QMenu* FindMenu(const ActionRegistry& registry, const QString& name)
+{
+    QMenu* menu = registry.FindMenu(name);
+    if(!menu)
+        throw std::logic_error(std::string("Unknown menu: ") + name.toStdString());
+    return menu;
+}
+
+// lazily built pages are created from event loop, where nothing may be thrown,
+// so everything config refers to is resolved while the caller can still handle errors
+struct ConfigValidator
+{
+    const ActionRegistry&                      registry;
+    const QMap<QString, TCustomWidgetCreator>& customWidgetCreators;
+    QSet<QString>                              menus;    //created from config, not registered yet
+    QSet<QString>                              contexts;
+
+    void Validate(const ToolbarConfig& config)
+    {
+        for(const MenuConfig& menuConfig : config.menus)
+            menus.insert(menuConfig.name);
+        for(const ContextConfig& contextConfig : config.contexts)
+            contexts.insert(contextConfig.name);
+
+        for(const QString& actionName : config.cornerActions)
+            FindAction(registry, actionName);
+        for(const MenuConfig& menuConfig : config.menus)
+            for(const QString& actionName : menuConfig.actions)
+                if(actionName != "separator")
+                    FindAction(registry, actionName);
+        for(const TabConfig& tab : config.tabs)
+            ValidateTab(tab);
+    }
+
+    void ValidateTab(const TabConfig& tab) const
+    {
+        if(!tab.context.isEmpty() && !contexts.contains(tab.context))
+            throw std::logic_error(std::string("Unknown tab context: ") + tab.context.toStdString());
+        for(const GroupConfig& group : tab.groups)
+            ValidateItems(group.content, false);
+    }
+
+    void ValidateItems(const QVector<ItemConfig>& items, bool inSubGroup) const
+    {
+        for(const ItemConfig& item : items)
+        {
+            switch(item.type)
+            {
+                case ItemConfig::Type::Action:
+                    ValidateAction(item.action);
+                    break;
+                case ItemConfig::Type::SubGroup:
+                case ItemConfig::Type::Separator:
+                    if(inSubGroup)
+                        throw std::logic_error("Subgroups may contain only actions and custom widgets!");
+                    ValidateItems(item.content, true);
+                    break;
+                case ItemConfig::Type::HorizontalActions:
+                    if(!inSubGroup)
+                        throw std::logic_error("Horizontal actions must be placed inside subgroup!");
+                    for(const ActionConfig& action : item.actions)
+                        ValidateAction(action);
+                    break;
+                case ItemConfig::Type::Custom:
+                    if(!customWidgetCreators.contains(item.customType))
+                        throw std::logic_error(std::string("Unknown item type: ") + item.customType.toStdString());
+                    break;
+            }
+        }
+    }
+
+    void ValidateAction(const ActionConfig& action) const
+    {
+        FindAction(registry, action.name);
+        if(!action.menu.isEmpty() && !menus.contains(action.menu))
+            FindMenu(registry, action.menu);
+    }
+};
+
+QMenu* CreateMenu(BuildContext& context, const MenuConfig& menuConfig, QWidget* parent)
+{
+    QMenu* menu = new QMenu(parent);
+    menu->setObjectName(menuConfig.name);
+    for(const QString& actionName : menuConfig.actions)
+    {
+        if(actionName == "separator")
+            menu->addSeparator();
+        else
+            menu->addAction(FindAction(context.registry, actionName));
+    }
+    context.registry.AddMenu(menu);
+    return menu;
+}
+
+QWidget* CreateCustomWidget(const BuildContext& context, const ItemConfig& item)
+{
+    if(!context.customWidgetCreators.contains(item.customType))
+        throw std::logic_error(std::string("Unknown item type: ") + item.customType.toStdString());
+    QWidget* w = context.customWidgetCreators[item.customType](item.properties);
+    if(!item.name.isEmpty())
+    {
+        w->setObjectName(item.name);
+        context.registerWidget(w->objectName(), w);
+    }
+    w->setParent(context.tabToolbar);
+    return w;
+}
+
+SubGroup::ActionParams CreateActionParams(const BuildContext& context, const ActionConfig& action)
+{
+    SubGroup::ActionParams params;
+    params.type = action.type;
+    params.action = FindAction(context.registry, action.name);
+    params.menu = nullptr;
+    if(!action.menu.isEmpty())
+        params.menu = FindMenu(context.registry, action.menu);
+    return params;
+}
+
+void CreateSubGroup(const BuildContext& context, Group& group, const ItemConfig& item, int index)
+{
+    SubGroup* subGroup = group.InsertSubGroup(index, item.aligned ? SubGroup::Align::Yes : SubGroup::Align::No);
+    subGroup->setObjectName(item.name);
+    context.registerWidget(item.name, subGroup);
+
+    for(const ItemConfig& sgItem : item.content)
+    {
+        switch(sgItem.type)
+        {
+            case ItemConfig::Type::Action:
+            {
+                SubGroup::ActionParams params = CreateActionParams(context, sgItem.action);
+                subGroup->AddAction(params.type, params.action, params.menu);
+                break;
+            }
+            case ItemConfig::Type::HorizontalActions:
+            {
+                std::vector<SubGroup::ActionParams> horizActions;
+                for(const ActionConfig& action : sgItem.actions)
+                    horizActions.push_back(CreateActionParams(context, action));
+                subGroup->AddHorizontalButtons(horizActions);
+                break;
+            }
+            case ItemConfig::Type::Custom:
+                subGroup->AddWidget(CreateCustomWidget(context, sgItem));
+                break;
+            default:
+                throw std::logic_error("Subgroups may contain only actions and custom widgets!");
+        }
+    }
+}
+
+void CreateItem(const BuildContext& context, Group& group, const ItemConfig& item, int index)
+{
+    switch(item.type)
+    {
+        case ItemConfig::Type::Action:
+        {
+            SubGroup::ActionParams params = CreateActionParams(context, item.action);
+            group.InsertAction(index, params.type, params.action, params.menu);
+            break;
+        }
+        case ItemConfig::Type::SubGroup:
+            CreateSubGroup(context, group, item, index);
+            break;
+        case ItemConfig::Type::Separator:
+            group.InsertSeparator(index);
+            break;
+        case ItemConfig::Type::Custom:
+            group.InsertWidget(index, CreateCustomWidget(context, item));
+            break;
+        default:
+            throw std::logic_error("Horizontal actions must be placed inside subgroup!");
+    }
+}
+
+void CreateGroup(const BuildContext& context, Page& page, const GroupConfig& groupConfig, int index = -1)
+{
+    Group* group = page.InsertGroup(index, groupConfig.displayName);
+    context.registerWidget(groupConfig.name, group);
+
+    for(const ItemConfig& item : groupConfig.content)
+        CreateItem(context, *group, item, -1);
+}
+
+void CollectWidgetNames(const GroupConfig& group, QStringList& names)
+{
+    names.append(group.name);
+    for(const ItemConfig& item : group.content)
+    {
+        if(item.type == ItemConfig::Type::Custom && !item.name.isEmpty())
+            names.append(item.name);
+        if(item.type != ItemConfig::Type::SubGroup)
+            continue;
+
+        names.append(item.name);
+        for(const ItemConfig& sgItem : item.content)
+            if(sgItem.type == ItemConfig::Type::Custom && !sgItem.name.isEmpty())
+                names.append(sgItem.name);
+    }
+}
+
+//Keeps pages of one toolbar in sync with a model, pages read their groups from the model when built
+class ModelView : public QObject
+{
+public:
+    ModelView(ToolbarModel& toolbarModel, const std::shared_ptr<BuildContext>& buildContext, bool lazyPages) :
+        QObject(buildContext->tabToolbar),
+        model(&toolbarModel),
+        context(buildContext),
+        lazy(lazyPages)
+    {
+        for(int i=0; i<model->Config().tabs.size(); i++)
+            InsertPage(i);
+
+        QObject::connect(model, &ToolbarModel::SettingsChanged, this, [this]() { ApplySettings(); });
+        QObject::connect(model, &ToolbarModel::ModelReset, this, [this]()
+        {
+            ApplySettings();
+            RecreatePages();
+        });
+        QObject::connect(model, &ToolbarModel::TabInserted, this, [this](int tabIndex)
+        {
+            // moved tab is removed and inserted again, it stays current
+            Page* page = InsertPage(tabIndex);
+            if(!removedCurrent.isNull() && removedCurrent == tabNames.at(tabIndex))
+                context->tabToolbar->SetCurrentPage(page);
+            removedCurrent.clear();
+        });
+        QObject::connect(model, &ToolbarModel::TabRemoved, this, [this](int tabIndex)
+        {
+            const bool current = (pages.at(tabIndex) == context->tabToolbar->CurrentPage());
+            removedCurrent = current ? tabNames.at(tabIndex) : QString();
+            tabNames.removeAt(tabIndex);
+            delete pages.takeAt(tabIndex).data();
+        });
+        QObject::connect(model, &ToolbarModel::GroupInserted, this, [this](int tabIndex, int groupIndex)
+        {
+            if(Page* page = BuiltPage(tabIndex))
+                page->ApplyCreatorChange([&]()
+                {
+                    CreateGroup(*context, *page, model->Config().tabs.at(tabIndex).groups.at(groupIndex), groupIndex);
+                });
+        });
+        QObject::connect(model, &ToolbarModel::GroupRemoved, this, [this](int tabIndex, int groupIndex)
+        {
+            if(Page* page = BuiltPage(tabIndex))
+                page->ApplyCreatorChange([&]() { page->RemoveGroup(groupIndex); });
+        });
+        QObject::connect(model, &ToolbarModel::ItemInserted, this, [this](int tabIndex, int groupIndex, int itemIndex)
+        {
+            if(Group* group = BuiltGroup(tabIndex, groupIndex))
+                pages.at(tabIndex)->ApplyCreatorChange([&]()
+                {
+                    CreateItem(*context, *group, Item(tabIndex, groupIndex, itemIndex), itemIndex);
+                });
+        });
+        QObject::connect(model, &ToolbarModel::ItemRemoved, this, [this](int tabIndex, int groupIndex, int itemIndex)
+        {
+            if(Group* group = BuiltGroup(tabIndex, groupIndex))
+                pages.at(tabIndex)->ApplyCreatorChange([&]() { group->RemoveItem(itemIndex); });
+        });
+        QObject::connect(model, &ToolbarModel::ItemChanged, this, [this](int tabIndex, int groupIndex, int itemIndex)
+        {
+            if(Group* group = BuiltGroup(tabIndex, groupIndex))
+                pages.at(tabIndex)->ApplyCreatorChange([&]()
+                {
+                    group->RemoveItem(itemIndex);
+                    CreateItem(*context, *group, Item(tabIndex, groupIndex, itemIndex), itemIndex);
+                });
+        });
+    }
+
+    QList<Page*> Pages() const
+    {
+        QList<Page*> result;
+        for(const QPointer<Page>& page : pages)
+            result.append(page);
+        return result;
+    }
+
+private:
+    // contexts and menus new to the model are needed by tabs and items which follow
+    void ApplySettings()
+    {
+        TabToolbar* tt = context->tabToolbar;
+        for(const ContextConfig& contextConfig : model->Config().contexts)
+            tt->AddContext(contextConfig.name, QColor(contextConfig.color));
+        for(const MenuConfig& menuConfig : model->Config().menus)
+        {
+            if(context->registry.FindMenu(menuConfig.name))
+                continue;
+            QMenu* menu = CreateMenu(*context, menuConfig, tt);
+            context->registerWidget(menu->objectName(), menu);
+        }
+    }
+
+    // page is placed before the one showing following tab, other pages are left intact
+    Page* InsertPage(int tabIndex)
+    {
+        TabToolbar* tt = context->tabToolbar;
+        const TabConfig& tab = model->Config().tabs.at(tabIndex);
+        Page* before = pages.value(tabIndex);
+        Page* page = tab.context.isEmpty() ? tt->InsertPage(before, tab.displayName)
+                                           : tt->InsertPage(before, tab.displayName, tab.context);
+        pages.insert(tabIndex, page);
+        tabNames.insert(tabIndex, tab.name);
+        context->registerWidget(tab.name, page);
+
+        // single creator, so that page always builds current model state of its tab
+        QPointer<ModelView> self(this);
+        page->AddDeferredGroup([self](Page& p)
+        {
+            if(!self || !self->model)
+                return;
+            const int index = self->pages.indexOf(&p);
+            if(index < 0)
+                return;
+            for(const GroupConfig& group : self->model->Config().tabs.at(index).groups)
+                CreateGroup(*self->context, p, group);
+        });
+
+        for(const GroupConfig& group : tab.groups)
+        {
+            QStringList names;
+            CollectWidgetNames(group, names);
+            for(const QString& name : names)
+                context->registerDeferred(name, page);
+        }
+
+        if(!lazy)
+            page->Materialize();
+        return page;
+    }
+
+    void RecreatePages()
+    {
+        TabToolbar* tt = context->tabToolbar;
+        TabToolbarUpdateGuard updateGuard(tt);
+        const int current = pages.indexOf(tt->CurrentPage());
+        const QString currentName = (current >= 0 ? tabNames.at(current) : QString());
+
+        while(!pages.isEmpty())
+        {
+            tabNames.removeLast();
+            delete pages.takeLast().data();
+        }
+        for(int i=0; i<model->Config().tabs.size(); i++)
+            InsertPage(i);
+
+        // recreated tab stays current
+        const int restored = currentName.isNull() ? -1 : tabNames.indexOf(currentName);
+        if(restored >= 0)
+            tt->SetCurrentPage(pages.at(restored));
+    }
+
+    Page* BuiltPage(int tabIndex) const
+    {
+        Page* page = pages.value(tabIndex);
+        if(!page || !page->IsMaterialized())
+            return nullptr; //not built pages read the model later
+        return page;
+    }
+
+    Group* BuiltGroup(int tabIndex, int groupIndex) const
+    {
+        Page* page = BuiltPage(tabIndex);
+        return page ? page->GetGroup(groupIndex) : nullptr;
+    }
+
+    const ItemConfig& Item(int tabIndex, int groupIndex, int itemIndex) const
+    {
+        return model->Config().tabs.at(tabIndex).groups.at(groupIndex).content.at(itemIndex);
+    }
+
+    QPointer<ToolbarModel>        model;
+    std::shared_ptr<BuildContext> context;
+    const bool                    lazy;
+    QList<QPointer<Page>>         pages;
+    QStringList                   tabNames; //model names of tabs pages were created for
+    QString                       removedCurrent; //name of current tab until it is inserted again
+};
+}
+
 Builder::Builder(QWidget* parent) : QObject(parent)
+{
+    registry.AddSearchRoot(parent);
+}
+
+Builder::Builder(QWidget* parent, const ActionRegistry& actionRegistry) :
+    QObject(parent),
+    registry(actionRegistry)
 {
 }
 
 QWidget* Builder::operator[](const QString& widgetName) const
 {
-    return guiWidgets.value(widgetName, nullptr);
+    // page was not built yet or has been hibernated, widgets get registered again
+    Page* page = deferredWidgets.value(widgetName);
+    if(page)
+        page->Materialize();
+    QWidget* widget = guiWidgets.value(widgetName);
+    // widget handed out would dangle once its page hibernates
+    if(widget && page)
+        page->Pin();
+    return widget;
 }
 
 void Builder::SetCustomWidgetCreator(const QString& name, const std::function<QWidget*()>& creator)
@@ -51,179 +596,251 @@ void Builder::SetCustomWidgetCreator(const QString& name, const std::function<QW
     customWidgetCreators[name] = creator;
 }
 
+void Builder::SetLazyPageConstruction(bool lazy)
+{
+    lazyPages = lazy;
+}
+
+void Builder::ReloadConfig(ToolbarModel& model, const QString& configPath)
+{
+    // model must not take changes its views would fail to build, it would never retry them
+    const ToolbarConfig config = LoadChangedConfig(configPath);
+    ConfigValidator{registry, customWidgetCreators, {}, {}}.Validate(config);
+    model.Update(config);
+}
+
+void Builder::WatchConfig(ToolbarModel& model, const QString& configPath)
+{
+    if(!watcher)
+    {
+        watcher = new QFileSystemWatcher(this);
+        QObject::connect(watcher, &QFileSystemWatcher::fileChanged, this, &Builder::ConfigFileChanged);
+    }
+    watchedModels[configPath] = &model;
+    watcher->addPath(configPath);
+}
+
+void Builder::ConfigFileChanged(const QString& configPath)
+{
+    // editors often save by replacing the file, which removes it from watcher
+    if(!watcher->files().contains(configPath) && QFile::exists(configPath))
+        watcher->addPath(configPath);
+
+    ToolbarModel* model = watchedModels.value(configPath);
+    if(!model)
+    {
+        watchedModels.remove(configPath);
+        watcher->removePath(configPath);
+        return;
+    }
+
+    try
+    {
+        ReloadConfig(*model, configPath);
+    }
+    catch(const std::exception& e)
+    {
+        // file may be half written, next change will bring it back
+        emit ConfigReloadFailed(configPath, QString::fromStdString(e.what()));
+    }
+}
+
+PreparedConfig tt::PrepareConfig(const QString& configPath)
+{
+    PreparedConfig prepared;
+    try
+    {
+        prepared.config = LoadConfig(configPath);
+    }
+    catch(const std::exception& e)
+    {
+        // QtConcurrent does not carry std exceptions over to the future
+        prepared.error = QString::fromStdString(e.what());
+        return prepared;
+    }
+
+    // QImage, unlike QPixmap, may be decoded outside of GUI thread
+    for(const QString& iconPath : CollectActionIcons(prepared.config))
+        if(!prepared.icons.contains(iconPath))
+            prepared.icons.insert(iconPath, QImage(iconPath));
+    return prepared;
+}
+
+QFuture<PreparedConfig> tt::PrepareConfigAsync(const QString& configPath)
+{
+    return QtConcurrent::run(&PrepareConfig, configPath);
+}
+
+ConfigCacheStats tt::GetConfigCacheStats()
+{
+    ConfigCache& cache = GetConfigCache();
+    QMutexLocker lock(&cache.mutex);
+    return cache.stats;
+}
+
+void tt::SetConfigCacheHook(const TConfigCacheHook& hook)
+{
+    ConfigCache& cache = GetConfigCache();
+    QMutexLocker lock(&cache.mutex);
+    cache.hook = hook;
+}
+
+void tt::ClearConfigCache()
+{
+    ConfigCache& cache = GetConfigCache();
+    QMutexLocker lock(&cache.mutex);
+    cache.entries.clear();
+    cache.stats = ConfigCacheStats();
+}
+
 TabToolbar* Builder::CreateTabToolbar(const QString& configPath)
 {
-    const QList<QAction*>& actions = parent()->findChildren<QAction*>();
-    const QList<QMenu*>& menus = parent()->findChildren<QMenu*>();
-    QMap<QString, QAction*> actionsMap;
-    QMap<QString, QMenu*> menusMap;
-    for(QAction* action : actions)
-        actionsMap.insert(action->objectName(), action);
-    for(QMenu* menu : menus)
-        menusMap.insert(menu->objectName(), menu);
+    return CreateTabToolbar(LoadConfig(configPath));
+}
+
+TabToolbar* Builder::CreateTabToolbar(const PreparedConfig& prepared)
+{
+    if(!prepared.error.isEmpty())
+        throw std::runtime_error(prepared.error.toStdString());
+    return CreateTabToolbar(prepared.config, prepared.icons);
+}
 
-    QFile configFile(configPath);
-    configFile.open(QIODevice::ReadOnly);
-    const QJsonDocument config(QJsonDocument::fromJson(configFile.readAll()));
-    const QJsonObject root = config.object();
-    const int groupHeight = root["groupHeight"].toInt();
-    const int groupRowCount = root["groupRowCount"].toInt();
-    const bool hasSpecialTab = root["specialTab"].toBool();
-    TabToolbar* tt = new TabToolbar((QWidget*)parent(), groupHeight, groupRowCount);
-
-    auto CreateCustomWidget = [this, tt](const QString& name, const QJsonObject& item)
-    {
-        if(!customWidgetCreators.contains(name))
-            throw std::logic_error(std::string("Unknown item type: ") + name.toStdString());
-        QWidget* w = customWidgetCreators[name](item);
-        if(item.contains("name"))
-        {
-            w->setObjectName(item["name"].toString());
-            guiWidgets[w->objectName()] = w;
-        }
-        w->setParent(tt);
-        return w;
-    };
+TabToolbar* Builder::CreateTabToolbarAsync(const QString& configPath, int sliceMs)
+{
+    return CreateInSlices([this, &configPath]() { return CreateTabToolbar(configPath); }, sliceMs);
+}
 
-    auto CreateActionParams = [this, &actionsMap, &menusMap](const QJsonObject& obj)
+TabToolbar* Builder::CreateTabToolbarAsync(const ToolbarConfig& config, int sliceMs)
+{
+    return CreateInSlices([this, &config]() { return CreateTabToolbar(config); }, sliceMs);
+}
+
+TabToolbar* Builder::CreateInSlices(const std::function<TabToolbar*()>& create, int sliceMs)
+{
+    const bool lazy = lazyPages;
+    lazyPages = true;
+    TabToolbar* tt = nullptr;
+    try
     {
-        SubGroup::ActionParams params;
-        const QString type = obj["type"].toString();
-        if(type == "delayedPopup")
-            params.type = QToolButton::DelayedPopup;
-        else if(type == "instantPopup")
-            params.type = QToolButton::InstantPopup;
-        else if(type == "menuButtonPopup")
-            params.type = QToolButton::MenuButtonPopup;
-        else
-            throw std::logic_error(std::string("Unknown toolbutton popup mode: ") + type.toStdString());
+        tt = create();
+    }
+    catch(...)
+    {
+        lazyPages = lazy;
+        throw;
+    }
+    lazyPages = lazy;
+    tt->MaterializeAsync(sliceMs);
+    return tt;
+}
 
-        params.action = actionsMap[obj["name"].toString()];
-        params.menu = nullptr;
-        if(obj.contains("menu") && !obj["menu"].isNull())
-            params.menu = menusMap[obj["menu"].toString()];
-        return params;
-    };
+TabToolbar* Builder::CreateTabToolbar(const uchar* data, qint64 size)
+{
+    return CreateTabToolbar(ParseConfigData(data, size));
+}
+
+TabToolbar* Builder::CreateTabToolbar(const ToolbarConfig& config)
+{
+    return CreateTabToolbar(config, QHash<QString, QImage>());
+}
 
-    const QJsonArray cornerActions = root["cornerActions"].toArray();
-    for(int i=0; i<cornerActions.size(); i++)
-        tt->AddCornerAction(actionsMap[cornerActions.at(i).toString()]);
+TabToolbar* Builder::CreateTabToolbar(ToolbarModel& model)
+{
+    return CreateTabToolbar(model.Config(), QHash<QString, QImage>(), &model);
+}
+
+TabToolbar* Builder::CreateTabToolbar(const ToolbarConfig& config, const QHash<QString, QImage>& icons, ToolbarModel* model)
+{
+    ConfigValidator{registry, customWidgetCreators, {}, {}}.Validate(config);
+
+    TabToolbar* tt = new TabToolbar((QWidget*)parent(), config.groupHeight, config.groupRowCount);
+    TabToolbarUpdateGuard updateGuard(tt);
+    tt->SetPaintedButtons(config.paintedButtons);
+
+    // pages keep their groups' config and build them on first selection,
+    // so the context must outlive this builder
+    auto context = std::make_shared<BuildContext>();
+    context->tabToolbar = tt;
+    context->registry = registry;
+
+    // actions belong to the application, icons it has set are left alone
+    const QMap<QString, QString> actionIcons = CollectActionIcons(config);
+    for(auto it = actionIcons.constBegin(); it != actionIcons.constEnd(); ++it)
+    {
+        QAction* action = FindAction(context->registry, it.key());
+        if(!action->icon().isNull())
+            continue;
+        const QImage image = icons.value(it.value());
+        action->setIcon(image.isNull() ? QIcon(it.value()) : QIcon(QPixmap::fromImage(image)));
+    }
+
+    for(const QString& actionName : config.cornerActions)
+        tt->AddCornerAction(FindAction(context->registry, actionName));
     
-    const QJsonArray menusList = root["menus"].toArray();
-    for(int i=0; i<menusList.size(); i++)
+    for(const MenuConfig& menuConfig : config.menus)
     {
-        const QJsonObject menuObject = menusList.at(i).toObject();
-        QMenu* menu = new QMenu((QWidget*)parent());
-        menu->setObjectName(menuObject["name"].toString());
-        menusMap[menu->objectName()] = menu;
+        QMenu* menu = CreateMenu(*context, menuConfig, (QWidget*)parent());
         guiWidgets[menu->objectName()] = menu;
-        const QJsonArray menuActions = menuObject["actions"].toArray();
-        for(int j=0; j<menuActions.size(); j++)
-        {
-            const QString actionName = menuActions.at(j).toString();
-            if(actionName == "separator")
-                menu->addSeparator();
-            else
-                menu->addActions({actionsMap[actionName]});
-        }
     }
 
-    const QJsonArray tabs = root["tabs"].toArray();
-    for(int i=0; i<tabs.size(); i++)
+    for(const ContextConfig& contextConfig : config.contexts)
+        tt->AddContext(contextConfig.name, QColor(contextConfig.color));
+
+    context->customWidgetCreators = customWidgetCreators;
+    QPointer<Builder> self(this);
+    context->registerWidget = [self](const QString& name, QWidget* widget)
     {
-        const QJsonObject tab = tabs.at(i).toObject();
-        const QString pageDisplayName = tab["displayName"].toString();
-        const QString pageName = tab["name"].toString();
-        Page* page = tt->AddPage(pageDisplayName);
-        guiWidgets[pageName] = page;
+        if(self)
+            self->guiWidgets[name] = widget;
+    };
+    context->registerDeferred = [self](const QString& name, Page* page)
+    {
+        if(self)
+            self->deferredWidgets[name] = page;
+    };
 
-        const QJsonArray groups = tab["groups"].toArray();
-        for(int j=0; j<groups.size(); j++)
+    QList<Page*> pages;
+    if(model)
+        pages = (new ModelView(*model, context, lazyPages))->Pages();
+    else
+    {
+        for(const TabConfig& tab : config.tabs)
         {
-            const QJsonObject groupObject = groups.at(j).toObject();
-            const QString groupDisplayName = groupObject["displayName"].toString();
-            const QString groupName = groupObject["name"].toString();
-            Group* group = page->AddGroup(groupDisplayName);
-            guiWidgets[groupName] = group;
+            Page* page = tab.context.isEmpty() ? tt->AddPage(tab.displayName)
+                                               : tt->AddPage(tab.displayName, tab.context);
+            guiWidgets[tab.name] = page;
+            pages.append(page);
 
-            const QJsonArray content = groupObject["content"].toArray();
-            for(int k=0; k<content.size(); k++)
+            for(const GroupConfig& group : tab.groups)
             {
-                const QJsonObject item = content.at(k).toObject();
-
-                static const QList<QString> defaultTypes = {"action", "subgroup", "separator"};
-                const QString itemType = item["itemType"].toString();
-                int type = defaultTypes.indexOf(itemType);
-                switch(type)
+                page->AddDeferredGroup([context, group](Page& p)
                 {
-                    case 0: //action
-                    {
-                        SubGroup::ActionParams params = CreateActionParams(item);
-                        group->AddAction(params.type, params.action, params.menu);
-                        break;
-                    }
-                    case 1: //subgroup
-                    {
-                        SubGroup::Align align = SubGroup::Align::Yes;
-                        if(!item["aligned"].toBool())
-                            align = SubGroup::Align::No;
-                        SubGroup* subGroup = group->AddSubGroup(align);
-                        const QString subGroupName = item["name"].toString();
-                        subGroup->setObjectName(subGroupName);
-                        guiWidgets[subGroupName] = subGroup;
-
-                        const QJsonArray subGroupContent = item["content"].toArray();
-                        for(int w=0; w<subGroupContent.size(); w++)
-                        {
-                            const QJsonObject sgItem = subGroupContent.at(w).toObject();
-
-                            static const QList<QString> defaultSgTypes = {"action", "horizontalActions"};
-                            const QString sgItemType = sgItem["itemType"].toString();
-                            int sgType = defaultSgTypes.indexOf(sgItemType);
-                            switch(sgType)
-                            {
-                                case 0: //action
-                                {
-                                    SubGroup::ActionParams params = CreateActionParams(sgItem);
-                                    subGroup->AddAction(params.type, params.action, params.menu);
-                                    break;
-                                }
-                                case 1: //horizontalActions
-                                {
-                                    std::vector<SubGroup::ActionParams> horizActions;
-                                    const QJsonArray horizActionsArray = sgItem["actions"].toArray();
-                                    for(int x=0; x<horizActionsArray.size(); x++)
-                                    {
-                                        const QJsonObject horizAction = horizActionsArray.at(x).toObject();
-                                        horizActions.push_back(CreateActionParams(horizAction));
-                                    }
-                                    subGroup->AddHorizontalButtons(horizActions);
-                                    break;
-                                }
-                                default:
-                                {
-                                    QWidget* w = CreateCustomWidget(sgItemType, sgItem);
-                                    subGroup->AddWidget(w);
-                                    break;
-                                }
-                            }
-                        }
-                        break;
-                    }
-                    case 2: //separator
-                        group->AddSeparator();
-                        break;
-                    default: //custom widget
-                    {
-                        QWidget* w = CreateCustomWidget(itemType, item);
-                        group->AddWidget(w);
-                        break;
-                    }
-                }
+                    CreateGroup(*context, p, group);
+                });
+
+                QStringList names;
+                CollectWidgetNames(group, names);
+                for(const QString& name : names)
+                    deferredWidgets[name] = page;
             }
+
+            if(!lazyPages)
+                page->Materialize();
         }
     }
 
-    tt->SetSpecialTabEnabled(hasSpecialTab);
+    tt->SetSpecialTabEnabled(config.specialTab);
+    // contextual pages start hidden, so tab index is not the page index
+    int tabIndex = tt->CurrentTab();
+    for(Page* page : pages)
+    {
+        if(!tt->IsPageVisible(page->Id()))
+            continue;
+        if(tabIndex-- == 0)
+        {
+            page->Materialize();
+            break;
+        }
+    }
     return tt;
 }
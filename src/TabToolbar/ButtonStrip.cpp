@@ -0,0 +1,950 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+    Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QAccessible>
+#include <QAccessibleWidget>
+#include <QAction>
+#include <QActionEvent>
+#include <QApplication>
+#include <QCursor>
+#include <QFocusEvent>
+#include <QHelpEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QStatusTipEvent>
+#include <QStyle>
+#include <QStyleOptionFrame>
+#include <QStyleOptionToolButton>
+#include <QToolTip>
+#include <algorithm>
+#include <TabToolbar/StyleTools.h>
+#include <TabToolbar/ToolbarContext.h>
+#include "ButtonStrip.h"
+#include "ToolButtonStyle.h"
+
+namespace tt
+{
+
+#ifndef QT_NO_ACCESSIBILITY
+//single painted button, exposed to assistive tools the way QToolButton is
+class StripButtonAccessible : public QAccessibleInterface, public QAccessibleActionInterface
+{
+public:
+    StripButtonAccessible(ButtonStrip* strip, int index) : strip(strip), index(index) {}
+
+    bool isValid() const override
+    {
+        return strip && index < strip->ButtonCount() && strip->ButtonAction(index);
+    }
+
+    //button is not a QObject, returning action would make accessibility cache own this interface
+    QObject* object() const override
+    {
+        return nullptr;
+    }
+
+    QWindow* window() const override
+    {
+        return strip ? strip->window()->windowHandle() : nullptr;
+    }
+
+    QAccessibleInterface* parent() const override
+    {
+        return QAccessible::queryAccessibleInterface(strip);
+    }
+
+    QAccessibleInterface* child(int) const override
+    {
+        return nullptr;
+    }
+
+    QAccessibleInterface* childAt(int, int) const override
+    {
+        return nullptr;
+    }
+
+    int childCount() const override
+    {
+        return 0;
+    }
+
+    int indexOfChild(const QAccessibleInterface*) const override
+    {
+        return -1;
+    }
+
+    QString text(QAccessible::Text t) const override
+    {
+        if(!isValid())
+            return QString();
+        const QAction* action = strip->ButtonAction(index);
+        switch(t)
+        {
+        case QAccessible::Name:
+        {
+            QString name = action->text();
+            return name.remove(QLatin1Char('&'));
+        }
+        case QAccessible::Description:
+            return action->toolTip();
+        case QAccessible::Help:
+            return action->statusTip();
+        case QAccessible::Accelerator:
+            return action->shortcut().toString(QKeySequence::NativeText);
+        default:
+            return QString();
+        }
+    }
+
+    void setText(QAccessible::Text, const QString&) override
+    {
+    }
+
+    QRect rect() const override
+    {
+        if(!isValid())
+            return QRect();
+        const QRect rect = strip->ButtonRect(index);
+        return QRect(strip->mapToGlobal(rect.topLeft()), rect.size());
+    }
+
+    QAccessible::Role role() const override
+    {
+        if(!isValid() || !strip->ButtonMenu(index))
+            return QAccessible::Button;
+        switch(strip->buttons[index].type)
+        {
+        case QToolButton::InstantPopup:    return QAccessible::ButtonMenu;
+        case QToolButton::MenuButtonPopup: return QAccessible::ButtonDropDown;
+        default:                           return QAccessible::Button;
+        }
+    }
+
+    QAccessible::State state() const override
+    {
+        QAccessible::State state;
+        if(!isValid())
+        {
+            state.invalid = true;
+            return state;
+        }
+        const QAction* action = strip->ButtonAction(index);
+        state.invisible = !strip->isVisible() || !strip->IsVisible(index);
+        state.disabled = !strip->IsEnabled(index);
+        state.hasPopup = strip->ButtonMenu(index) != nullptr;
+        state.checkable = action->isCheckable();
+        state.checked = action->isChecked();
+        state.hotTracked = strip->hovered == index;
+        state.pressed = strip->pressed == index;
+        state.focusable = true;
+        state.focused = strip->hasFocus() && strip->focused == index;
+        return state;
+    }
+
+    void* interface_cast(QAccessible::InterfaceType type) override
+    {
+        if(type == QAccessible::ActionInterface)
+            return static_cast<QAccessibleActionInterface*>(this);
+        return nullptr;
+    }
+
+    QStringList actionNames() const override
+    {
+        QStringList names;
+        if(!isValid() || !strip->IsEnabled(index))
+            return names;
+        if(strip->buttons[index].type != QToolButton::InstantPopup || !strip->ButtonMenu(index))
+            names << pressAction();
+        if(strip->ButtonMenu(index))
+            names << showMenuAction();
+        return names;
+    }
+
+    void doAction(const QString& actionName) override
+    {
+        if(!isValid() || !strip->IsEnabled(index))
+            return;
+        if(actionName == pressAction())
+            strip->TriggerButton(index);
+        else if(actionName == showMenuAction())
+            strip->ShowMenu(index);
+    }
+
+    QStringList keyBindingsForAction(const QString&) const override
+    {
+        return QStringList();
+    }
+
+private:
+    QPointer<ButtonStrip> strip;
+    const int             index;
+};
+
+class ButtonStripAccessible : public QAccessibleWidget
+{
+public:
+    explicit ButtonStripAccessible(ButtonStrip* strip) : QAccessibleWidget(strip, QAccessible::ToolBar) {}
+
+    int childCount() const override
+    {
+        return Strip()->ButtonCount();
+    }
+
+    QAccessibleInterface* child(int index) const override
+    {
+        ButtonStrip* strip = Strip();
+        if(index < 0 || index >= strip->ButtonCount())
+            return nullptr;
+        std::vector<unsigned>& ids = strip->accessibleIds;
+        if(ids.size() <= size_t(index))
+            ids.resize(strip->ButtonCount(), 0);
+        if(!ids[index])
+            ids[index] = QAccessible::registerAccessibleInterface(new StripButtonAccessible(strip, index));
+        return QAccessible::accessibleInterface(ids[index]);
+    }
+
+    int indexOfChild(const QAccessibleInterface* child) const override
+    {
+        const std::vector<unsigned>& ids = Strip()->accessibleIds;
+        for(size_t i=0; i<ids.size(); i++)
+            if(ids[i] && QAccessible::accessibleInterface(ids[i]) == child)
+                return int(i);
+        return -1;
+    }
+
+    QAccessibleInterface* childAt(int x, int y) const override
+    {
+        ButtonStrip* strip = Strip();
+        return child(strip->ButtonAt(strip->mapFromGlobal(QPoint(x, y))));
+    }
+
+private:
+    ButtonStrip* Strip() const
+    {
+        return static_cast<ButtonStrip*>(widget());
+    }
+};
+
+namespace
+{
+QAccessibleInterface* CreateStripAccessible(const QString& key, QObject* object)
+{
+    if(key == QLatin1String("tt::ButtonStrip") && object && object->isWidgetType())
+        return new ButtonStripAccessible(static_cast<ButtonStrip*>(object));
+    return nullptr;
+}
+}
+#endif
+
+ButtonStrip::ButtonStrip(Qt::Orientation _orientation, const std::shared_ptr<ToolbarContext>& _context, QWidget* parent) :
+    QWidget(parent),
+    orientation(_orientation),
+    context(_context)
+{
+#ifndef QT_NO_ACCESSIBILITY
+    static const bool factoryInstalled = (QAccessible::installFactory(&CreateStripAccessible), true);
+    Q_UNUSED(factoryInstalled);
+#endif
+
+    setProperty("TTInternal", QVariant(true));
+    if(context->buttonStyle)
+        context->buttonStyle->AddDependent(this);
+    setMouseTracking(true);
+    //buttons take Tab focus one by one, as QToolButtons do
+    setFocusPolicy(Qt::TabFocus);
+    setAttribute(Qt::WA_NoSystemBackground);
+    if(orientation == Qt::Horizontal)
+        setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Minimum);
+    else
+        setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Fixed);
+
+    popupTimer.setSingleShot(true);
+    QObject::connect(&popupTimer, &QTimer::timeout, this, [this]()
+    {
+        if(pressed >= 0 && !pressedMenu)
+            ShowMenu(pressed);
+    });
+}
+
+ButtonStrip::~ButtonStrip()
+{
+#ifndef QT_NO_ACCESSIBILITY
+    for(unsigned id : accessibleIds)
+        if(id)
+            QAccessible::deleteAccessibleInterface(id);
+#endif
+}
+
+void ButtonStrip::AddButton(Kind kind, QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu, int row)
+{
+    buttons.push_back(Button{kind, type, action, menu, row, QRect()});
+    //keeps action shortcuts alive the way QToolButton::setDefaultAction does
+    addAction(action);
+    Invalidate();
+}
+
+int ButtonStrip::RowCount() const
+{
+    int rows = 0;
+    for(const Button& button : buttons)
+        rows = std::max(rows, button.row + 1);
+    return rows;
+}
+
+int ButtonStrip::ButtonCount() const
+{
+    return int(buttons.size());
+}
+
+QAction* ButtonStrip::ButtonAction(int index) const
+{
+    return buttons[index].action;
+}
+
+QMenu* ButtonStrip::ButtonMenu(int index) const
+{
+    const Button& button = buttons[index];
+    if(button.menu)
+        return button.menu;
+    return button.action ? button.action->menu() : nullptr;
+}
+
+QRect ButtonStrip::ButtonRect(int index) const
+{
+    EnsureLayout();
+    return buttons[index].rect;
+}
+
+int ButtonStrip::ButtonAt(const QPoint& pos) const
+{
+    EnsureLayout();
+    for(int i=0; i<ButtonCount(); i++)
+        if(IsVisible(i) && buttons[i].rect.contains(pos))
+            return i;
+    return -1;
+}
+
+void ButtonStrip::TriggerButton(int index)
+{
+    if(QAction* action = buttons[index].action)
+        action->trigger();
+}
+
+void ButtonStrip::ShowMenu(int index)
+{
+    QMenu* menu = ButtonMenu(index);
+    if(!menu)
+        return;
+
+    popupTimer.stop();
+    pressed = index;
+    pressedMenu = true;
+    update();
+
+    //menu may close toolbar along with this strip
+    QPointer<ButtonStrip> self(this);
+    menu->exec(mapToGlobal(ButtonRect(index).bottomLeft()));
+    if(!self)
+        return;
+
+    pressed = -1;
+    pressedMenu = false;
+    UpdateHover();
+    update();
+}
+
+void ButtonStrip::SetContext(const std::shared_ptr<ToolbarContext>& newContext)
+{
+    context = newContext;
+    if(context->buttonStyle)
+        context->buttonStyle->AddDependent(this);
+    Invalidate();
+}
+
+QSize ButtonStrip::sizeHint() const
+{
+    EnsureLayout();
+    return contentSize;
+}
+
+QSize ButtonStrip::minimumSizeHint() const
+{
+    return sizeHint();
+}
+
+bool ButtonStrip::event(QEvent* event)
+{
+    switch(event->type())
+    {
+    case QEvent::ToolTip:
+    {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        const int index = ButtonAt(helpEvent->pos());
+        if(index >= 0 && !buttons[index].action->toolTip().isEmpty())
+            QToolTip::showText(helpEvent->globalPos(), buttons[index].action->toolTip(), this, buttons[index].rect);
+        else
+            QToolTip::hideText();
+        return true;
+    }
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+        Invalidate();
+        break;
+    case QEvent::EnabledChange:
+        update();
+        break;
+    default:
+        break;
+    }
+    return QWidget::event(event);
+}
+
+void ButtonStrip::paintEvent(QPaintEvent* event)
+{
+    EnsureLayout();
+    QPainter painter(this);
+    PaintHorizontalFrames(painter);
+    for(int i=0; i<ButtonCount(); i++)
+    {
+        if(!IsVisible(i) || !event->rect().intersects(buttons[i].rect))
+            continue;
+
+        QStyleOptionToolButton option;
+        InitOption(i, option);
+        if(IsCompact(i))
+        {
+            PaintCompact(painter, i, option);
+            continue;
+        }
+        QWidget* styleWidget = StyleWidget(buttons[i].kind);
+        styleWidget->style()->drawComplexControl(QStyle::CC_ToolButton, &option, &painter, styleWidget);
+    }
+}
+
+void ButtonStrip::mousePressEvent(QMouseEvent* event)
+{
+    const int index = (event->button() == Qt::LeftButton ? ButtonAt(event->pos()) : -1);
+    if(index < 0 || !IsEnabled(index))
+    {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    if(IsMenuArea(index, event->pos()))
+    {
+        ShowMenu(index);
+        return;
+    }
+
+    pressed = index;
+    pressedMenu = false;
+    if(buttons[index].type == QToolButton::DelayedPopup && ButtonMenu(index))
+        popupTimer.start(StyleWidget(buttons[index].kind)->style()->styleHint(QStyle::SH_ToolButton_PopupDelay, nullptr, this));
+    update();
+}
+
+void ButtonStrip::mouseReleaseEvent(QMouseEvent* event)
+{
+    if(event->button() != Qt::LeftButton || pressed < 0 || pressedMenu)
+    {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+
+    popupTimer.stop();
+    const int index = pressed;
+    pressed = -1;
+    update();
+    if(ButtonAt(event->pos()) == index && IsEnabled(index))
+        TriggerButton(index);
+}
+
+void ButtonStrip::mouseMoveEvent(QMouseEvent* event)
+{
+    const int index = ButtonAt(event->pos());
+    SetHover(index, index >= 0 && IsMenuArea(index, event->pos()));
+    QWidget::mouseMoveEvent(event);
+}
+
+void ButtonStrip::leaveEvent(QEvent* event)
+{
+    SetHover(-1, false);
+    QWidget::leaveEvent(event);
+}
+
+void ButtonStrip::resizeEvent(QResizeEvent* event)
+{
+    //buttons of horizontal strip take its full height
+    layoutDirty = true;
+    QWidget::resizeEvent(event);
+}
+
+void ButtonStrip::actionEvent(QActionEvent* event)
+{
+    if(event->type() == QEvent::ActionRemoved)
+    {
+        if(hovered >= 0 && buttons[hovered].action == event->action())
+            SetHover(-1, false);
+        if(pressed >= 0 && buttons[pressed].action == event->action())
+            pressed = -1;
+    }
+    Invalidate();
+    QWidget::actionEvent(event);
+}
+
+void ButtonStrip::keyPressEvent(QKeyEvent* event)
+{
+    const bool valid = (focused >= 0 && focused < ButtonCount() && IsVisible(focused) && IsEnabled(focused));
+    switch(event->key())
+    {
+    case Qt::Key_Left:
+    case Qt::Key_Up:
+        MoveFocus(-1);
+        return;
+    case Qt::Key_Down:
+        if(event->modifiers() & Qt::AltModifier)
+        {
+            if(valid)
+                ShowMenu(focused);
+            return;
+        }
+        MoveFocus(1);
+        return;
+    case Qt::Key_Right:
+        MoveFocus(1);
+        return;
+    case Qt::Key_Space:
+    case Qt::Key_Enter:
+    case Qt::Key_Return:
+        if(!valid)
+            break;
+        if(buttons[focused].type == QToolButton::InstantPopup && ButtonMenu(focused))
+            ShowMenu(focused);
+        else
+            TriggerButton(focused);
+        return;
+    default:
+        break;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+void ButtonStrip::focusInEvent(QFocusEvent* event)
+{
+    const bool valid = (focused >= 0 && focused < ButtonCount() && IsVisible(focused) && IsEnabled(focused));
+    if(!valid || event->reason() == Qt::TabFocusReason || event->reason() == Qt::BacktabFocusReason)
+    {
+        const bool back = (event->reason() == Qt::BacktabFocusReason);
+        focused = (back ? ButtonCount() : -1);
+        if(!MoveFocus(back ? -1 : 1))
+            focused = -1;
+    }
+    update();
+    QWidget::focusInEvent(event);
+}
+
+void ButtonStrip::focusOutEvent(QFocusEvent* event)
+{
+    update();
+    QWidget::focusOutEvent(event);
+}
+
+//Tab walks buttons of the strip before leaving it
+bool ButtonStrip::focusNextPrevChild(bool next)
+{
+    if(hasFocus() && MoveFocus(next ? 1 : -1))
+        return true;
+    return QWidget::focusNextPrevChild(next);
+}
+
+QWidget* ButtonStrip::StyleWidget(Kind kind) const
+{
+    QWidget* proxy = (kind == Kind::Large ? context->largeButtonProxy : context->smallButtonProxy);
+    return proxy ? proxy : const_cast<ButtonStrip*>(this);
+}
+
+int ButtonStrip::IconSize(Kind kind) const
+{
+    const QStyle::PixelMetric metric = (kind == Kind::Large ? QStyle::PM_LargeIconSize : QStyle::PM_SmallIconSize);
+    return GetPixelMetric(metric) * context->scaleFactor;
+}
+
+int ButtonStrip::RowHeight() const
+{
+    return context->groupMaxHeight / context->rowCount;
+}
+
+bool ButtonStrip::IsVisible(int index) const
+{
+    const QAction* action = buttons[index].action;
+    return action && action->isVisible();
+}
+
+bool ButtonStrip::IsEnabled(int index) const
+{
+    const QAction* action = buttons[index].action;
+    return isEnabled() && action && action->isEnabled();
+}
+
+bool ButtonStrip::IsCompact(int index) const
+{
+    return buttons[index].kind == Kind::Large && buttons[index].type == QToolButton::MenuButtonPopup;
+}
+
+bool ButtonStrip::IsMenuArea(int index, const QPoint& pos) const
+{
+    const Button& button = buttons[index];
+    if(!ButtonMenu(index))
+        return false;
+    if(button.type == QToolButton::InstantPopup)
+        return true;
+    if(button.type != QToolButton::MenuButtonPopup)
+        return false;
+    if(IsCompact(index))
+        return pos.y() >= button.rect.top() + IconSize(button.kind) + 5;
+
+    QStyleOptionToolButton option;
+    InitOption(index, option);
+    QWidget* styleWidget = StyleWidget(button.kind);
+    return styleWidget->style()->subControlRect(QStyle::CC_ToolButton, &option, QStyle::SC_ToolButtonMenu, styleWidget).contains(pos);
+}
+
+//mirrors QToolButton::initStyleOption of autoraised button with default action
+void ButtonStrip::InitOption(int index, QStyleOptionToolButton& option) const
+{
+    const Button& button = buttons[index];
+    const QAction* action = button.action;
+
+    option.initFrom(StyleWidget(button.kind));
+    //style animations would be shared by all buttons of proxy
+    option.styleObject = nullptr;
+    option.rect = button.rect;
+    option.state &= ~(QStyle::State_Enabled | QStyle::State_MouseOver | QStyle::State_HasFocus);
+    option.state |= QStyle::State_AutoRaise;
+
+    option.subControls = QStyle::SC_ToolButton;
+    option.activeSubControls = QStyle::SC_None;
+    option.features = QStyleOptionToolButton::None;
+    if(button.type == QToolButton::MenuButtonPopup)
+    {
+        option.subControls |= QStyle::SC_ToolButtonMenu;
+        option.features |= QStyleOptionToolButton::MenuButtonPopup;
+    }
+    else if(button.type == QToolButton::DelayedPopup)
+    {
+        option.features |= QStyleOptionToolButton::PopupDelay;
+    }
+    if(ButtonMenu(index))
+        option.features |= QStyleOptionToolButton::HasMenu;
+
+    if(IsEnabled(index))
+    {
+        option.state |= QStyle::State_Enabled;
+        if(hovered == index)
+        {
+            option.state |= QStyle::State_MouseOver;
+            option.activeSubControls = (hoveredMenu ? QStyle::SC_ToolButtonMenu : QStyle::SC_ToolButton);
+        }
+    }
+    if(focused == index && hasFocus())
+        option.state |= QStyle::State_HasFocus;
+    if(pressed == index && (pressedMenu || hovered == index))
+    {
+        option.state |= QStyle::State_Sunken;
+        option.activeSubControls |= (pressedMenu ? QStyle::SC_ToolButtonMenu : QStyle::SC_ToolButton);
+    }
+    if(action && action->isChecked())
+        option.state |= QStyle::State_On;
+    else if(!(option.state & QStyle::State_Sunken))
+        option.state |= QStyle::State_Raised;
+
+    const int iconSize = IconSize(button.kind);
+    option.iconSize = QSize(iconSize, iconSize);
+    switch(button.kind)
+    {
+    case Kind::Large:    option.toolButtonStyle = Qt::ToolButtonTextUnderIcon; break;
+    case Kind::Small:    option.toolButtonStyle = Qt::ToolButtonTextBesideIcon; break;
+    case Kind::IconOnly: option.toolButtonStyle = Qt::ToolButtonIconOnly; break;
+    }
+    if(!action)
+        return;
+
+    option.icon = action->icon();
+    option.text = action->iconText();
+    if(option.toolButtonStyle == Qt::ToolButtonTextBesideIcon && action->priority() < QAction::NormalPriority)
+        option.toolButtonStyle = Qt::ToolButtonIconOnly;
+    if(option.icon.isNull())
+        option.toolButtonStyle = (option.text.isEmpty() ? Qt::ToolButtonIconOnly : Qt::ToolButtonTextOnly);
+}
+
+//mirrors QToolButton::sizeHint
+QSize ButtonStrip::ContentsSize(Kind kind, const QStyleOptionToolButton& option) const
+{
+    int w = 0;
+    int h = 0;
+    if(option.toolButtonStyle != Qt::ToolButtonTextOnly)
+    {
+        w = option.iconSize.width();
+        h = option.iconSize.height();
+    }
+    if(option.toolButtonStyle != Qt::ToolButtonIconOnly)
+    {
+        const QFontMetrics& fm = option.fontMetrics;
+        QSize textSize = fm.size(Qt::TextShowMnemonic, option.text);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+        textSize.rwidth() += fm.horizontalAdvance(QLatin1Char(' ')) * 2;
+#else
+        textSize.rwidth() += fm.width(QLatin1Char(' ')) * 2;
+#endif
+        if(option.toolButtonStyle == Qt::ToolButtonTextUnderIcon)
+        {
+            h += 4 + textSize.height();
+            w = std::max(w, textSize.width());
+        }
+        else if(option.toolButtonStyle == Qt::ToolButtonTextBesideIcon)
+        {
+            w += 4 + textSize.width();
+            h = std::max(h, textSize.height());
+        }
+        else
+        {
+            w = textSize.width();
+            h = textSize.height();
+        }
+    }
+
+    QWidget* styleWidget = StyleWidget(kind);
+    QStyleOptionToolButton sizeOption = option;
+    sizeOption.rect.setSize(QSize(w, h));
+    if(option.features & QStyleOptionToolButton::MenuButtonPopup)
+        w += styleWidget->style()->pixelMetric(QStyle::PM_MenuButtonIndicator, &sizeOption, styleWidget);
+    return styleWidget->style()->sizeFromContents(QStyle::CT_ToolButton, &sizeOption, QSize(w, h), styleWidget);
+}
+
+QSize ButtonStrip::ButtonSize(int index) const
+{
+    const Button& button = buttons[index];
+    QStyleOptionToolButton option;
+    InitOption(index, option);
+    if(!IsCompact(index))
+        return ContentsSize(button.kind, option);
+
+    //same parts CompactToolButton is made of: icon button over text button with menu
+    QStyleOptionToolButton up = option;
+    up.toolButtonStyle = Qt::ToolButtonIconOnly;
+    up.features = QStyleOptionToolButton::None;
+    up.subControls = QStyle::SC_ToolButton;
+    QStyleOptionToolButton down = option;
+    down.toolButtonStyle = Qt::ToolButtonTextOnly;
+    down.features = QStyleOptionToolButton::HasMenu;
+    down.subControls = QStyle::SC_ToolButton;
+    down.text = (button.action ? button.action->text() : QString());
+    const QSize upSize = ContentsSize(button.kind, up);
+    const QSize downSize = ContentsSize(button.kind, down);
+    return QSize(std::max(upSize.width(), downSize.width()), option.iconSize.height() + 5 + std::max(downSize.height(), 25));
+}
+
+void ButtonStrip::EnsureLayout() const
+{
+    if(!layoutDirty)
+        return;
+    layoutDirty = false;
+
+    if(orientation == Qt::Horizontal)
+    {
+        const int spacing = 4;
+        int x = 0;
+        int maxHeight = 0;
+        for(int i=0; i<ButtonCount(); i++)
+        {
+            if(!IsVisible(i))
+                continue;
+            const QSize size = ButtonSize(i);
+            buttons[i].rect = QRect(x, 0, size.width(), std::max(height(), size.height()));
+            x += size.width() + spacing;
+            maxHeight = std::max(maxHeight, size.height());
+        }
+        contentSize = QSize(std::max(0, x - spacing), maxHeight);
+        return;
+    }
+
+    //rows are as tall as inner frames of SubGroup, buttons are packed to the left
+    const int rowHeight = RowHeight();
+    const int rows = RowCount();
+    std::vector<int> rowWidths(rows, 0);
+    for(int i=0; i<ButtonCount(); i++)
+    {
+        if(!IsVisible(i))
+            continue;
+        Button& button = buttons[i];
+        const QSize size = ButtonSize(i);
+        button.rect = QRect(rowWidths[button.row], button.row * (rowHeight + 1), size.width(), rowHeight);
+        rowWidths[button.row] += size.width();
+    }
+    const int width = (rows > 0 ? *std::max_element(rowWidths.begin(), rowWidths.end()) : 0);
+    contentSize = QSize(width, std::max(0, rows * (rowHeight + 1) - 1));
+}
+
+void ButtonStrip::Invalidate()
+{
+    layoutDirty = true;
+    updateGeometry();
+    update();
+}
+
+void ButtonStrip::PaintCompact(QPainter& painter, int index, const QStyleOptionToolButton& option) const
+{
+    QWidget* styleWidget = StyleWidget(buttons[index].kind);
+    QStyle* style = styleWidget->style();
+    const int upHeight = option.iconSize.height() + 5;
+
+    //whole button is highlighted when any of its parts is hovered
+    if(option.state & QStyle::State_MouseOver)
+    {
+        QStyleOptionToolButton overlay = option;
+        overlay.icon = QIcon();
+        overlay.text.clear();
+        overlay.features = QStyleOptionToolButton::None;
+        overlay.subControls = QStyle::SC_ToolButton;
+        overlay.activeSubControls = QStyle::SC_ToolButton;
+        overlay.state &= ~(QStyle::State_Sunken | QStyle::State_On);
+        overlay.state |= QStyle::State_Raised;
+        style->drawComplexControl(QStyle::CC_ToolButton, &overlay, &painter, styleWidget);
+    }
+
+    QStyleOptionToolButton up = option;
+    up.rect.setHeight(upHeight);
+    up.toolButtonStyle = Qt::ToolButtonIconOnly;
+    up.text.clear();
+    up.features = QStyleOptionToolButton::None;
+    up.subControls = QStyle::SC_ToolButton;
+    if(hoveredMenu)
+        up.state &= ~QStyle::State_MouseOver;
+    if(pressedMenu)
+        up.state &= ~QStyle::State_Sunken;
+    style->drawComplexControl(QStyle::CC_ToolButton, &up, &painter, styleWidget);
+
+    QStyleOptionToolButton down = option;
+    down.rect.setTop(option.rect.top() + upHeight);
+    down.toolButtonStyle = Qt::ToolButtonTextOnly;
+    down.icon = QIcon();
+    down.text = buttons[index].action->text();
+    down.features = QStyleOptionToolButton::HasMenu;
+    down.subControls = QStyle::SC_ToolButton;
+    down.state &= ~QStyle::State_On;
+    if(!hoveredMenu)
+        down.state &= ~QStyle::State_MouseOver;
+    if(!pressedMenu)
+        down.state &= ~QStyle::State_Sunken;
+    style->drawComplexControl(QStyle::CC_ToolButton, &down, &painter, styleWidget);
+}
+
+//rows of horizontal buttons get the frame SubGroup puts around them when buttons are widgets
+void ButtonStrip::PaintHorizontalFrames(QPainter& painter) const
+{
+    QFrame* proxy = context->horizontalFrameProxy;
+    if(!proxy)
+        return;
+
+    std::vector<QRect> rowRects(RowCount());
+    for(int i=0; i<ButtonCount(); i++)
+        if(buttons[i].kind == Kind::IconOnly && IsVisible(i))
+            rowRects[buttons[i].row] |= buttons[i].rect;
+
+    //proxy is never shown, style sheet sets its styled background on polish
+    proxy->ensurePolished();
+    QStyle* style = proxy->style();
+    for(const QRect& rect : rowRects)
+    {
+        if(rect.isNull())
+            continue;
+
+        //what QWidget and QFrame paint for the proxy, style sheet background included
+        if(proxy->testAttribute(Qt::WA_StyledBackground))
+        {
+            QStyleOption option;
+            option.initFrom(proxy);
+            option.rect = rect;
+            style->drawPrimitive(QStyle::PE_Widget, &option, &painter, proxy);
+        }
+        QStyleOptionFrame frame;
+        frame.initFrom(proxy);
+        frame.rect = rect;
+        frame.lineWidth = proxy->lineWidth();
+        frame.midLineWidth = proxy->midLineWidth();
+        style->drawControl(QStyle::CE_ShapedFrame, &frame, &painter, proxy);
+    }
+}
+
+void ButtonStrip::SetHover(int index, bool menuArea)
+{
+    if(index == hovered && menuArea == hoveredMenu)
+        return;
+
+    const QString oldTip = (hovered >= 0 && buttons[hovered].action ? buttons[hovered].action->statusTip() : QString());
+    const QString newTip = (index >= 0 && buttons[index].action ? buttons[index].action->statusTip() : QString());
+    const bool changed = (index != hovered);
+    hovered = index;
+    hoveredMenu = menuArea;
+    update();
+
+    if(changed && (!oldTip.isEmpty() || !newTip.isEmpty()))
+    {
+        QStatusTipEvent tip(newTip);
+        QApplication::sendEvent(this, &tip);
+    }
+}
+
+bool ButtonStrip::MoveFocus(int step)
+{
+    for(int i = focused + step; i >= 0 && i < ButtonCount(); i += step)
+    {
+        if(IsVisible(i) && IsEnabled(i))
+        {
+            SetFocused(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ButtonStrip::SetFocused(int index)
+{
+    focused = index;
+    update();
+#ifndef QT_NO_ACCESSIBILITY
+    if(hasFocus() && QAccessible::isActive())
+    {
+        QAccessibleEvent focusEvent(this, QAccessible::Focus);
+        focusEvent.setChild(index);
+        QAccessible::updateAccessibility(&focusEvent);
+    }
+#endif
+}
+
+void ButtonStrip::UpdateHover()
+{
+    const QPoint pos = mapFromGlobal(QCursor::pos());
+    const int index = (underMouse() ? ButtonAt(pos) : -1);
+    SetHover(index, index >= 0 && IsMenuArea(index, pos));
+}
+
+}
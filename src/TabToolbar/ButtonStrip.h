@@ -0,0 +1,132 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+    Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_BUTTON_STRIP_H
+#define TT_BUTTON_STRIP_H
+#include <QPointer>
+#include <QTimer>
+#include <QToolButton>
+#include <QWidget>
+#include <memory>
+#include <vector>
+
+class QAction;
+class QActionEvent;
+class QFocusEvent;
+class QKeyEvent;
+class QMenu;
+class QPainter;
+class QStyleOptionToolButton;
+
+namespace tt
+{
+struct ToolbarContext;
+
+//Row (in Group) or column of rows (in SubGroup) of tool buttons painted by a single widget,
+//used instead of QToolButton per action when toolbar has painted buttons enabled.
+//Hit-testing, hover, press, menus, tooltips, keyboard focus and accessibility are handled here.
+class ButtonStrip : public QWidget
+{
+    Q_OBJECT
+public:
+    enum class Kind
+    {
+        Large,   //icon over text, as in Group
+        Small,   //icon beside text, as in SubGroup
+        IconOnly //as in horizontal buttons of SubGroup
+    };
+
+    ButtonStrip(Qt::Orientation orientation, const std::shared_ptr<ToolbarContext>& context, QWidget* parent = nullptr);
+    virtual ~ButtonStrip();
+
+    void     AddButton(Kind kind, QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu, int row = 0);
+    int      RowCount() const;
+    int      ButtonCount() const;
+    QAction* ButtonAction(int index) const;
+    QMenu*   ButtonMenu(int index) const;
+    QRect    ButtonRect(int index) const;
+    int      ButtonAt(const QPoint& pos) const;
+    void     TriggerButton(int index);
+    void     ShowMenu(int index);
+    void     SetContext(const std::shared_ptr<ToolbarContext>& newContext);
+
+    QSize    sizeHint() const override;
+    QSize    minimumSizeHint() const override;
+
+protected:
+    bool     event(QEvent* event) override;
+    void     paintEvent(QPaintEvent* event) override;
+    void     mousePressEvent(QMouseEvent* event) override;
+    void     mouseReleaseEvent(QMouseEvent* event) override;
+    void     mouseMoveEvent(QMouseEvent* event) override;
+    void     leaveEvent(QEvent* event) override;
+    void     resizeEvent(QResizeEvent* event) override;
+    void     actionEvent(QActionEvent* event) override;
+    void     keyPressEvent(QKeyEvent* event) override;
+    void     focusInEvent(QFocusEvent* event) override;
+    void     focusOutEvent(QFocusEvent* event) override;
+    bool     focusNextPrevChild(bool next) override;
+
+private:
+    struct Button
+    {
+        Kind                             kind;
+        QToolButton::ToolButtonPopupMode type;
+        QPointer<QAction>                action;
+        QPointer<QMenu>                  menu;
+        int                              row;
+        QRect                            rect;
+    };
+
+    QWidget* StyleWidget(Kind kind) const;
+    int      IconSize(Kind kind) const;
+    int      RowHeight() const;
+    bool     IsVisible(int index) const;
+    bool     IsEnabled(int index) const;
+    bool     IsCompact(int index) const;
+    bool     IsMenuArea(int index, const QPoint& pos) const;
+    void     InitOption(int index, QStyleOptionToolButton& option) const;
+    QSize    ContentsSize(Kind kind, const QStyleOptionToolButton& option) const;
+    QSize    ButtonSize(int index) const;
+    void     EnsureLayout() const;
+    void     Invalidate();
+    void     PaintCompact(QPainter& painter, int index, const QStyleOptionToolButton& option) const;
+    void     PaintHorizontalFrames(QPainter& painter) const;
+    void     SetHover(int index, bool menuArea);
+    void     UpdateHover();
+    bool     MoveFocus(int step);
+    void     SetFocused(int index);
+
+    const Qt::Orientation           orientation;
+    std::shared_ptr<ToolbarContext> context;
+    mutable std::vector<Button>     buttons; //rects are laid out on demand
+    mutable bool                    layoutDirty = true;
+    mutable QSize                   contentSize;
+    int                             hovered = -1;
+    bool                            hoveredMenu = false;
+    int                             pressed = -1;
+    bool                            pressedMenu = false;
+    int                             focused = -1; //button keyboard focus is on while strip has focus
+    QTimer                          popupTimer;
+    mutable std::vector<unsigned>   accessibleIds; //QAccessible::Id of button interfaces, created on demand
+
+    friend class ButtonStripAccessible;
+    friend class StripButtonAccessible;
+};
+
+}
+#endif
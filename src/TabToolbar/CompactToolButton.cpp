@@ -29,6 +29,7 @@
 #include <QScreen>
 #include <TabToolbar/StyleTools.h>
 #include <TabToolbar/TabToolbar.h>
+#include <TabToolbar/ToolbarContext.h>
 #include "CompactToolButton.h"
 #include "ToolButtonStyle.h"
 
@@ -123,19 +124,23 @@ private:
 namespace tt
 {
 
-CompactToolButton::CompactToolButton(QAction* action, QMenu* menu, QWidget* parent) :
+CompactToolButton::CompactToolButton(QAction* action, QMenu* menu, const ToolbarContext& context, QWidget* parent) :
     QFrame(parent)
 {
+    TTToolButtonStyle* buttonStyle = context.buttonStyle.get();
+
     overlay = new TTOverlayToolButton(this);
 
-    const int iconSize = GetPixelMetric(QStyle::PM_LargeIconSize) * GetScaleFactor(*this);
+    const int iconSize = GetPixelMetric(QStyle::PM_LargeIconSize) * context.scaleFactor;
     upButton = new QToolButton(this);
     upButton->setProperty("TTInternal", QVariant(true));
     upButton->setAutoRaise(true);
     upButton->setDefaultAction(action);
     upButton->setIconSize(QSize(iconSize, iconSize));
+    upButton->setProperty("TTIconMetric", QVariant(int(QStyle::PM_LargeIconSize)));
+    upButton->setProperty("TTCompactIcon", QVariant(true));
     upButton->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Maximum);
-    upButton->setStyle(new TTToolButtonStyle());
+    upButton->setStyle(buttonStyle);
     upButton->setMaximumHeight(iconSize + 5);
 
     QVBoxLayout* l = new QVBoxLayout(this);
@@ -157,7 +162,7 @@ CompactToolButton::CompactToolButton(QAction* action, QMenu* menu, QWidget* pare
     downButton->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Minimum);
     downButton->setText(action->text());
     downButton->setToolTip(action->toolTip());
-    downButton->setStyle(new TTToolButtonStyle());
+    downButton->setStyle(buttonStyle);
 
     if(menu)
     {
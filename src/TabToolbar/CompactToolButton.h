@@ -26,12 +26,13 @@ class QToolButton;
 
 namespace tt
 {
+struct ToolbarContext;
 
 class CompactToolButton: public QFrame
 {
     Q_OBJECT
 public:
-    CompactToolButton(QAction* action, QMenu* menu, QWidget* parent = nullptr);
+    CompactToolButton(QAction* action, QMenu* menu, const ToolbarContext& context, QWidget* parent = nullptr);
     virtual ~CompactToolButton() = default;
 
     void SetHover(bool hover);
@@ -30,16 +30,26 @@
 #include <QStyleOptionToolButton>
 #include <stdexcept>
 #include <TabToolbar/Group.h>
+#include <TabToolbar/Page.h>
 #include <TabToolbar/Styles.h>
 #include <TabToolbar/StyleTools.h>
 #include <TabToolbar/SubGroup.h>
 #include <TabToolbar/TabToolbar.h>
+#include <TabToolbar/ToolbarContext.h>
+#include "ButtonStrip.h"
 #include "CompactToolButton.h"
 #include "ToolButtonStyle.h"
 
 using namespace tt;
 
-Group::Group(const QString& name, QWidget* parent) : QFrame(parent)
+Group::Group(const QString& name, QWidget* parent) :
+    Group(name, FindToolbarContext(parent), parent)
+{
+}
+
+Group::Group(const QString& name, const std::shared_ptr<ToolbarContext>& _context, QWidget* parent) :
+    QFrame(parent),
+    context(_context)
 {
     setFrameShape(NoFrame);
     setLineWidth(0);
@@ -76,7 +86,7 @@ Group::Group(const QString& name, QWidget* parent) : QFrame(parent)
 
     outerLayout->addWidget(innerFrame);
 
-    QLabel* groupName = new QLabel(name, this);
+    groupName = new QLabel(name, this);
     groupName->setProperty("TTGroupName", QVariant(true));
     groupName->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Maximum);
     groupName->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
@@ -84,21 +94,53 @@ Group::Group(const QString& name, QWidget* parent) : QFrame(parent)
 
     outerLayout->addWidget(groupName);
 
-    const auto* parentTT = _FindTabToolbarParent(*this);
-    if (!parentTT)
-        throw std::runtime_error("Group should be constructed inside TabToolbar!");
+    UpdateHeight();
+}
+
+void Group::SetContext(const std::shared_ptr<ToolbarContext>& newContext)
+{
+    if(context == newContext)
+        return;
+
+    context = newContext;
+    ApplyContext();
+}
+
+void Group::SetOwner(Page* page)
+{
+    owner = page;
+    for(SubGroup* sgrp : findChildren<SubGroup*>())
+        sgrp->owner = page;
+}
+
+void Group::ApplyContext()
+{
+    UpdateHeight();
+    for(SubGroup* sgrp : findChildren<SubGroup*>())
+        sgrp->SetContext(context);
+    for(ButtonStrip* strip : findChildren<ButtonStrip*>(QString(), Qt::FindDirectChildrenOnly))
+        strip->SetContext(context);
+}
 
-    unsigned groupMaxHeight = parentTT->GroupMaxHeight();
-    unsigned rowCount = parentTT->RowCount();
-    const unsigned height = groupMaxHeight + groupName->height() + rowCount - 1;
+void Group::UpdateHeight()
+{
+    const unsigned height = context->groupMaxHeight + groupName->height() + context->rowCount - 1;
     setMinimumHeight(height);
     setMaximumHeight(height);
 }
 
 SubGroup* Group::AddSubGroup(SubGroup::Align align)
 {
-    SubGroup* sgrp = new SubGroup(align, this);
-    innerLayout->addWidget(sgrp);
+    return InsertSubGroup(-1, align);
+}
+
+SubGroup* Group::InsertSubGroup(int index, SubGroup::Align align)
+{
+    if(owner)
+        owner->GroupChanged();
+    SubGroup* sgrp = new SubGroup(align, context, this);
+    sgrp->owner = owner;
+    innerLayout->insertWidget(index, sgrp);
     return sgrp;
 }
 
@@ -116,36 +158,82 @@ QFrame* Group::CreateSeparator()
 
 void Group::AddSeparator()
 {
-    innerLayout->addWidget(CreateSeparator());
+    InsertSeparator(-1);
+}
+
+void Group::InsertSeparator(int index)
+{
+    if(owner)
+        owner->GroupChanged();
+    innerLayout->insertWidget(index, CreateSeparator());
 }
 
 void Group::AddAction(QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu)
 {
-    if(type == QToolButton::MenuButtonPopup)
+    InsertAction(-1, type, action, menu);
+}
+
+void Group::InsertAction(int index, QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu)
+{
+    if(owner)
+        owner->GroupChanged();
+    if(context->paintedButtons)
+    {
+        //one strip per item keeps item indices intact for Insert*/RemoveItem
+        ButtonStrip* strip = new ButtonStrip(Qt::Horizontal, context, this);
+        strip->AddButton(ButtonStrip::Kind::Large, type, action, menu);
+        innerLayout->insertWidget(index, strip);
+    }
+    else if(type == QToolButton::MenuButtonPopup)
     {
-        innerLayout->addWidget(new CompactToolButton(action, menu, this));
+        innerLayout->insertWidget(index, new CompactToolButton(action, menu, *context, this));
     }
     else
     {
-        const int iconSize = GetPixelMetric(QStyle::PM_LargeIconSize) * GetScaleFactor(*this);
+        const int iconSize = GetPixelMetric(QStyle::PM_LargeIconSize) * context->scaleFactor;
         QToolButton* btn = new QToolButton(this);
         btn->setProperty("TTInternal", QVariant(true));
         btn->setAutoRaise(true);
         btn->setDefaultAction(action);
         btn->setIconSize(QSize(iconSize, iconSize));
+        btn->setProperty("TTIconMetric", QVariant(int(QStyle::PM_LargeIconSize)));
         btn->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Minimum);
         btn->setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
         btn->setPopupMode(type);
-        btn->setStyle(new TTToolButtonStyle());
+        btn->setStyle(context->buttonStyle.get());
         if(menu)
             btn->setMenu(menu);
-        innerLayout->addWidget(btn);
+        innerLayout->insertWidget(index, btn);
     }
 }
 
 void Group::AddWidget(QWidget* widget)
 {
+    InsertWidget(-1, widget);
+}
+
+void Group::InsertWidget(int index, QWidget* widget)
+{
+    if(owner)
+        owner->GroupChanged();
     widget->setParent(this);
     widget->setProperty("TTInternal", QVariant(true));
-    innerLayout->addWidget(widget);
+    widget->setProperty("TTCustomWidget", QVariant(true));
+    innerLayout->insertWidget(index, widget);
+}
+
+void Group::RemoveItem(int index)
+{
+    if(owner)
+        owner->GroupChanged();
+    QLayoutItem* item = innerLayout->takeAt(index);
+    if(!item)
+        throw std::out_of_range("Group item index is out of range!");
+    delete item->widget();
+    delete item;
+}
+
+int Group::ItemCount() const
+{
+    return innerLayout->count();
 }
@@ -0,0 +1,303 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+    Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QEvent>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStyleOption>
+#include <QTabBar>
+#include <QWidget>
+#include <algorithm>
+#include <TabToolbar/Styles.h>
+#include "NativeStyle.h"
+
+using namespace tt;
+
+namespace
+{
+bool HasProperty(const QWidget* widget, const char* name)
+{
+    return widget && widget->property(name).toBool();
+}
+
+QBrush MakeBrush(const Colors& colors)
+{
+    if(colors.size() == 0)
+        return QBrush(Qt::NoBrush);
+    if(colors.size() == 1)
+        return QBrush(colors[0].value);
+
+    //same direction as qlineargradient(x1:0, y1:1, x2:0, y2:0) in style template
+    QLinearGradient gradient(0.0, 1.0, 0.0, 0.0);
+    gradient.setCoordinateMode(QGradient::ObjectBoundingMode);
+    for(const Color& col : colors)
+        gradient.setColorAt(col.coefficient, col.value);
+    return QBrush(gradient);
+}
+
+void FillBorders(QPainter* p, const QRect& r, const Colors* top, const Colors* bottom, const Colors* side)
+{
+    if(side)
+    {
+        p->fillRect(QRect(r.left(), r.top(), 1, r.height()), MakeBrush(*side));
+        p->fillRect(QRect(r.right(), r.top(), 1, r.height()), MakeBrush(*side));
+    }
+    if(top)
+        p->fillRect(QRect(r.left(), r.top(), r.width(), 1), MakeBrush(*top));
+    if(bottom)
+        p->fillRect(QRect(r.left(), r.bottom(), r.width(), 1), MakeBrush(*bottom));
+}
+}
+
+void TTNativeStyle::SetParams(const std::shared_ptr<const StyleParams>& styleParams)
+{
+    params = styleParams;
+}
+
+void TTNativeStyle::polish(QWidget* widget)
+{
+    TTToolButtonStyle::polish(widget);
+    if(!params)
+        return;
+
+    if(HasProperty(widget, "TTHide"))
+    {
+        QPalette palette = widget->palette();
+        palette.setColor(QPalette::ButtonText, params->HideArrowColor);
+        widget->setPalette(palette);
+    }
+    else if(HasProperty(widget, "TTGroupName"))
+    {
+        QPalette palette = widget->palette();
+        palette.setColor(QPalette::WindowText, params->GroupNameColor);
+        widget->setPalette(palette);
+    }
+    else if(HasProperty(widget, "TTTab"))
+    {
+        widget->setAttribute(Qt::WA_Hover);
+    }
+    else if(HasProperty(widget, "TTPage"))
+    {
+        //palette brush would be inherited by user widgets, so page background is painted in eventFilter
+        widget->installEventFilter(this);
+    }
+}
+
+void TTNativeStyle::unpolish(QWidget* widget)
+{
+    if(HasProperty(widget, "TTHide") || HasProperty(widget, "TTGroupName"))
+        widget->setPalette(QPalette());
+    else if(HasProperty(widget, "TTPage"))
+        widget->removeEventFilter(this);
+    TTToolButtonStyle::unpolish(widget);
+}
+
+bool TTNativeStyle::eventFilter(QObject* watched, QEvent* event)
+{
+    if(event->type() == QEvent::Paint && params)
+    {
+        QWidget* page = static_cast<QWidget*>(watched);
+        const QRect r = page->rect();
+        QPainter p(page);
+        p.fillRect(r, MakeBrush(params->PaneColor));
+        FillBorders(&p, r, &params->BorderColor, &params->BorderColor, nullptr);
+    }
+    return TTToolButtonStyle::eventFilter(watched, event);
+}
+
+void TTNativeStyle::drawPrimitive(PrimitiveElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const
+{
+    if(params)
+    {
+        if(element == PE_PanelToolBar && HasProperty(widget, "TabToolbar"))
+        {
+            p->fillRect(opt->rect, MakeBrush(params->ToolbarBackgroundColor));
+            return;
+        }
+        if(element == PE_FrameTabWidget && HasProperty(widget, "TTWidget"))
+            return;
+        if(element == PE_FrameTabBarBase && HasProperty(widget, "TTTab"))
+            return;
+    }
+    TTToolButtonStyle::drawPrimitive(element, opt, p, widget);
+}
+
+void TTNativeStyle::drawControl(ControlElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const
+{
+    if(!params)
+        return TTToolButtonStyle::drawControl(element, opt, p, widget);
+
+    switch(element)
+    {
+    case CE_ToolBar:
+        if(HasProperty(widget, "TabToolbar"))
+        {
+            p->fillRect(opt->rect, MakeBrush(params->ToolbarBackgroundColor));
+            return;
+        }
+        break;
+    case CE_TabBarTabShape:
+        if(HasProperty(widget, "TTTab"))
+        {
+            if(const QStyleOptionTab* tab = qstyleoption_cast<const QStyleOptionTab*>(opt))
+            {
+                DrawTabShape(*tab, p, widget);
+                return;
+            }
+        }
+        break;
+    case CE_TabBarTabLabel:
+        if(HasProperty(widget, "TTTab"))
+        {
+            if(const QStyleOptionTab* tab = qstyleoption_cast<const QStyleOptionTab*>(opt))
+            {
+                QStyleOptionTab label = *tab;
+                // contextual tabs carry their color in option palette, see QTabBar::setTabTextColor
+                const QColor tabColor = tab->palette.color(widget->foregroundRole());
+                const QColor color = tabColor != widget->palette().color(widget->foregroundRole()) ? tabColor :
+                                     IsSpecialTab(*tab, widget) ? params->TabSpecialFontColor : params->TabFontColor;
+                label.rect.adjust(0, 0, -params->TabSpacing, 0);
+                label.palette.setColor(QPalette::WindowText, color);
+                label.palette.setColor(QPalette::ButtonText, color);
+                QProxyStyle::drawControl(element, &label, p, widget);
+                return;
+            }
+        }
+        break;
+    case CE_ShapedFrame:
+        if(HasProperty(widget, "TTSeparator"))
+        {
+            const QRect& r = opt->rect;
+            p->fillRect(QRect(r.center().x(), r.top(), 1, r.height()), MakeBrush(params->SeparatorColor));
+            return;
+        }
+        if(HasProperty(widget, "TTHorizontalFrame"))
+        {
+            const qreal radius = params->HorizontalFrameBorderSize;
+            const QRectF r = QRectF(opt->rect).adjusted(0.5, 0.5, -0.5, -0.5);
+            p->save();
+            p->setRenderHint(QPainter::Antialiasing);
+            p->setPen(QPen(MakeBrush(params->HorizontalFrameBorderColor), 1.0));
+            p->setBrush(MakeBrush(params->HorizontalFrameBackgroundColor));
+            p->drawRoundedRect(r, radius, radius);
+            p->restore();
+            return;
+        }
+        break;
+    case CE_ToolButtonLabel:
+        if(HasProperty(widget, "TTHide"))
+            return QProxyStyle::drawControl(element, opt, p, widget);
+        break;
+    default:
+        break;
+    }
+    TTToolButtonStyle::drawControl(element, opt, p, widget);
+}
+
+void TTNativeStyle::drawComplexControl(ComplexControl cc, const QStyleOptionComplex* opt, QPainter* p, const QWidget* widget) const
+{
+    if(cc == CC_ToolButton && HasProperty(widget, "TTHide"))
+        return QProxyStyle::drawComplexControl(cc, opt, p, widget);
+    TTToolButtonStyle::drawComplexControl(cc, opt, p, widget);
+}
+
+int TTNativeStyle::pixelMetric(PixelMetric metric, const QStyleOption* opt, const QWidget* widget) const
+{
+    switch(metric)
+    {
+    case PM_ToolBarFrameWidth:
+    case PM_ToolBarItemMargin:
+        if(HasProperty(widget, "TabToolbar"))
+            return 0;
+        break;
+    case PM_DefaultFrameWidth:
+        if(HasProperty(widget, "TTWidget"))
+            return 0;
+        break;
+    default:
+        break;
+    }
+    return TTToolButtonStyle::pixelMetric(metric, opt, widget);
+}
+
+QSize TTNativeStyle::sizeFromContents(ContentsType type, const QStyleOption* opt, const QSize& contentsSize, const QWidget* widget) const
+{
+    QSize size = TTToolButtonStyle::sizeFromContents(type, opt, contentsSize, widget);
+    if(type == CT_TabBarTab && params && HasProperty(widget, "TTTab"))
+    {
+        //min-width, min-height and margin-right from style template
+        size.setWidth(std::max(size.width(), 50) + params->TabSpacing);
+        size.setHeight(std::max(size.height(), 20));
+    }
+    return size;
+}
+
+bool TTNativeStyle::IsSpecialTab(const QStyleOptionTab& tab, const QWidget* widget) const
+{
+    if(!HasProperty(widget, "TTSpecial"))
+        return false;
+    const QTabBar* tabBar = qobject_cast<const QTabBar*>(widget);
+    return tabBar && tabBar->tabAt(tab.rect.center()) == 0;
+}
+
+void TTNativeStyle::DrawTabShape(const QStyleOptionTab& tab, QPainter* p, const QWidget* widget) const
+{
+    QRect r = tab.rect.adjusted(0, 0, -params->TabSpacing, 0);
+    const bool hover = tab.state & State_MouseOver;
+    const bool selected = tab.state & State_Selected;
+    const bool enabled = tab.state & State_Enabled;
+
+    p->save();
+    if(IsSpecialTab(tab, widget))
+    {
+        const Colors& border = (hover ? params->TabSpecialHoverBorderColor : params->TabSpecialBorderColor);
+        const Colors& side = (hover ? params->TabSpecialHoverBorderColorSide : params->TabSpecialBorderColorSide);
+        p->fillRect(r, MakeBrush(hover ? params->TabSpecialHoverColor : params->TabSpecialColor));
+        FillBorders(p, r, &border, &border, &side);
+    }
+    else if(selected && enabled)
+    {
+        const QBrush background = MakeBrush(params->TabSelectedColor);
+        const int radius = params->TabBorderRadius;
+        if(radius > 0)
+        {
+            //only top corners are rounded
+            QPainterPath path;
+            path.setFillRule(Qt::WindingFill);
+            path.addRoundedRect(r, radius, radius);
+            path.addRect(r.adjusted(0, r.height() / 2, 0, 0));
+            p->setRenderHint(QPainter::Antialiasing);
+            p->fillPath(path.simplified(), background);
+            p->setRenderHint(QPainter::Antialiasing, false);
+        }
+        else
+        {
+            p->fillRect(r, background);
+        }
+        const Colors& top = (hover ? params->TabHoverBorderColorTop : params->BorderColor);
+        const Colors& side = (hover ? params->TabHoverBorderColorSide : params->BorderColor);
+        FillBorders(p, r, &top, nullptr, &side);
+    }
+    else if(hover)
+    {
+        r.adjust(0, 0, 0, -1);
+        p->fillRect(r, MakeBrush(params->TabUnselectedColor));
+        FillBorders(p, r, &params->TabUnselectedHoverBorderColorTop, nullptr, &params->TabUnselectedHoverBorderColorSide);
+    }
+    p->restore();
+}
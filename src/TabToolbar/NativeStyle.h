@@ -0,0 +1,56 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+    Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TT_NATIVE_STYLE
+#define TT_NATIVE_STYLE
+#include <memory>
+#include "ToolButtonStyle.h"
+
+class QStyleOptionTab;
+
+namespace tt
+{
+class StyleParams;
+
+//paints tabtoolbar parts from StyleParams colors, without style sheets
+class TTNativeStyle : public TTToolButtonStyle
+{
+public:
+    void SetParams(const std::shared_ptr<const StyleParams>& styleParams);
+
+    using QProxyStyle::polish;
+    using QProxyStyle::unpolish;
+    void  polish(QWidget* widget) override;
+    void  unpolish(QWidget* widget) override;
+    void  drawPrimitive(PrimitiveElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const override;
+    void  drawControl(ControlElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const override;
+    void  drawComplexControl(ComplexControl cc, const QStyleOptionComplex* opt, QPainter* p, const QWidget* widget) const override;
+    int   pixelMetric(PixelMetric metric, const QStyleOption* opt, const QWidget* widget) const override;
+    QSize sizeFromContents(ContentsType type, const QStyleOption* opt, const QSize& contentsSize, const QWidget* widget) const override;
+
+protected:
+    bool  eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void  DrawTabShape(const QStyleOptionTab& tab, QPainter* p, const QWidget* widget) const;
+    bool  IsSpecialTab(const QStyleOptionTab& tab, const QWidget* widget) const;
+
+    std::shared_ptr<const StyleParams> params;
+};
+
+}
+#endif
@@ -23,10 +23,13 @@
 #include <QWheelEvent>
 #include <QScrollBar>
 #include <QEvent>
+#include <QLayout>
+#include <algorithm>
 #include <stdexcept>
 #include <TabToolbar/TabToolbar.h>
 #include <TabToolbar/Page.h>
 #include <TabToolbar/Group.h>
+#include <TabToolbar/ToolbarContext.h>
 
 using namespace tt;
 
@@ -51,6 +54,18 @@ protected:
         return QObject::eventFilter(watched, event);
     }
 };
+
+//creators may throw, changes made by hand afterwards must still pin the page
+class MaterializingScope
+{
+public:
+    explicit MaterializingScope(bool& _flag) : flag(_flag), previous(_flag) { flag = true; }
+    ~MaterializingScope() { flag = previous; }
+
+private:
+    bool& flag;
+    const bool previous;
+};
 }
 
 Page::Page(int index, const QString& pageName, QWidget* parent)
@@ -65,7 +80,7 @@ Page::Page(int index, const QString& pageName, QWidget* parent)
     l->setSpacing(0);
     setLayout(l);
 
-    QScrollArea* scrollArea = new QScrollArea(this);
+    scrollArea = new QScrollArea(this);
     scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     scrollArea->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::MinimumExpanding);
@@ -90,15 +105,186 @@ Page::Page(int index, const QString& pageName, QWidget* parent)
 
 Group* Page::AddGroup(const QString& name)
 {
-    Group* grp = new Group(name, innerArea);
-    innerLayout->insertWidget(innerLayout->count()-1, grp);
+    return AddGroup(new Group(name, Context()));
+}
 
-    auto* parentTT = _FindTabToolbarParent(*this);
+Group* Page::AddGroup(Group* group)
+{
+    return InsertGroup(-1, group);
+}
+
+Group* Page::InsertGroup(int index, const QString& name)
+{
+    return InsertGroup(index, new Group(name, Context()));
+}
+
+Group* Page::InsertGroup(int index, Group* group)
+{
+    TabToolbar* parentTT = Context()->toolbar;
     if (!parentTT)
         throw std::runtime_error("Page should be constructed inside TabToolbar!");
 
-    parentTT->AdjustVerticalSize(grp->height());
-    return grp;
+    if(!materializing)
+        pinned = true;
+    group->setParent(innerArea);
+    group->SetContext(context);
+    group->SetOwner(this);
+    innerLayout->insertWidget(index < 0 ? GroupCount() : index, group);
+    group->show();
+
+    parentTT->AdjustVerticalSize(group->height());
+    return group;
+}
+
+int Page::ApplyContext()
+{
+    int groupHeight = 0;
+    for(Group* group : innerArea->findChildren<Group*>(QString(), Qt::FindDirectChildrenOnly))
+    {
+        group->ApplyContext();
+        groupHeight = std::max(groupHeight, group->height());
+    }
+    return groupHeight;
+}
+
+const std::shared_ptr<ToolbarContext>& Page::Context()
+{
+    if(!context)
+        context = FindToolbarContext(this);
+    return context;
+}
+
+void Page::AddDeferredGroup(const TGroupCreator& creator)
+{
+    deferredGroups.push_back(creator);
+}
+
+Group* Page::GetGroup(int index) const
+{
+    if(index < 0 || index >= GroupCount())
+        return nullptr;
+    return qobject_cast<Group*>(innerLayout->itemAt(index)->widget());
+}
+
+void Page::RemoveGroup(int index)
+{
+    Group* group = GetGroup(index);
+    if(!group)
+        throw std::out_of_range("Group index is out of range!");
+    if(!materializing)
+        pinned = true;
+    delete group;
+}
+
+int Page::GroupCount() const
+{
+    return innerLayout->count() - 1; //trailing spacer
+}
+
+bool Page::IsMaterialized() const
+{
+    return builtGroups == deferredGroups.size();
+}
+
+void Page::Materialize()
+{
+    if(IsMaterialized())
+        return;
+
+    TabToolbarUpdateGuard updateGuard(Context()->toolbar);
+    MaterializingScope scope(materializing);
+    while(builtGroups < deferredGroups.size())
+    {
+        // counted before it runs, so that a failing creator is not retried forever
+        const TGroupCreator creator = deferredGroups[builtGroups++];
+        creator(*this);
+    }
+}
+
+bool Page::MaterializeNext()
+{
+    if(IsMaterialized())
+        return false;
+
+    TabToolbarUpdateGuard updateGuard(Context()->toolbar);
+    MaterializingScope scope(materializing);
+    const TGroupCreator creator = deferredGroups[builtGroups++];
+    creator(*this);
+    return !IsMaterialized();
+}
+
+int Page::Id() const
+{
+    return myIndex;
+}
+
+bool Page::CanHibernate() const
+{
+    // only pages which can be rebuilt from their creators without losing user state
+    if(builtGroups == 0 || pinned)
+        return false;
+    for(const QWidget* widget : innerArea->findChildren<QWidget*>())
+        if(widget->property("TTCustomWidget").toBool())
+            return false;
+    return true;
+}
+
+void Page::Pin()
+{
+    pinned = true;
+}
+
+bool Page::IsPinned() const
+{
+    return pinned;
+}
+
+void Page::ApplyCreatorChange(const std::function<void()>& change)
+{
+    MaterializingScope scope(materializing);
+    change();
+}
+
+// groups and subgroups changed outside of creators would be lost on hibernation
+void Page::GroupChanged()
+{
+    if(!materializing)
+        pinned = true;
+}
+
+bool Page::Hibernate()
+{
+    if(!CanHibernate())
+        return false;
+
+    for(Group* group : innerArea->findChildren<Group*>(QString(), Qt::FindDirectChildrenOnly))
+        delete group;
+    builtGroups = 0;
+    return true;
+}
+
+void Page::Rebuild()
+{
+    // unlike hibernation, groups are dropped unconditionally since their description has changed
+    const bool wasBuilt = builtGroups > 0;
+    for(Group* group : innerArea->findChildren<Group*>(QString(), Qt::FindDirectChildrenOnly))
+        delete group;
+    builtGroups = 0;
+    pinned = false;
+    if(wasBuilt)
+        Materialize();
+}
+
+std::size_t Page::EstimateMemoryUsage() const
+{
+    // rough footprint of a widget and a layout together with their private data
+    const std::size_t widgetCost = 1024;
+    const std::size_t layoutCost = 256;
+
+    std::size_t usage = sizeof(Page) + deferredGroups.size() * sizeof(TGroupCreator);
+    usage += innerArea->findChildren<QWidget*>().size() * widgetCost;
+    usage += innerArea->findChildren<QLayout*>().size() * layoutCost;
+    return usage;
 }
 
 void Page::hide()
@@ -17,19 +17,25 @@
 */
 #include <QApplication>
 #include <QFile>
+#include <QHash>
 #include <QLocale>
 #include <QMap>
 #include <QMetaProperty>
+#include <QPair>
+#include <QPalette>
 #include <QScreen>
 #include <QStyle>
 #include <QSysInfo>
+#include <QVector>
 #include <QtGlobal>
 #include <QWidget>
+#include <QWindow>
 #if (QT_VERSION <= QT_VERSION_CHECK(5, 10, 0))
 #include <QDesktopWidget>
 #endif
 #include <stdexcept>
 #include <cstddef>
+#include <vector>
 #include <TabToolbar/StyleTools.h>
 
 namespace tt
@@ -37,16 +43,28 @@ namespace tt
 
 static std::unique_ptr<QMap<QString, TStyleCreator>> styleMap;
 
-static QString GetStyleTemplate()
+struct StyleCache
 {
-    static QString styleTemplate;
-    if(!styleTemplate.isEmpty())
-        return styleTemplate;
+    QHash<QPair<QString, uint>, CachedStyle> styles;
+    StyleCacheStats                          stats;
+};
 
-    QFile f(":/tt/StyleTemplate.qss");
-    f.open(QFile::ReadOnly);
-    styleTemplate = f.readAll();
-    return styleTemplate;
+static StyleCache& GetStyleCache()
+{
+    static StyleCache cache;
+    return cache;
+}
+
+static void RemoveCachedStyle(const QString& styleName)
+{
+    auto& styles = GetStyleCache().styles;
+    for(auto it = styles.begin(); it != styles.end();)
+    {
+        if(it.key().first == styleName)
+            it = styles.erase(it);
+        else
+            ++it;
+    }
 }
 
 static QString FormatColor(const QColor& col)
@@ -72,47 +90,158 @@ static QString FormatColor(const Colors& colors)
     return result;
 }
 
-static void FillStyle(QString& style, const StyleParams& params)
+static QString FormatProperty(const QMetaProperty& prop, const QVariant& property)
 {
-    style.clear();
-    if(params.UseTemplateSheet)
-        style = GetStyleTemplate();
-    style += params.AdditionalStyleSheet;
-
-    int numProps = params.metaObject()->propertyCount();
-    for(int i=0; i<numProps; i++)
-    {
-        const QMetaProperty prop = params.metaObject()->property(i);
-        if(QString(prop.name()) == "objectName")
-            continue;
-        if(prop.type() == QVariant::Bool)
-            continue;
-        const QString propStr = QString("%") + prop.name() + "%";
-        if(!style.contains(propStr))
-            continue;
-        style.replace(propStr, "%1");
-
-        const QVariant property = params.property(prop.name());
-        switch(prop.type())
+    switch(prop.type())
+    {
+        case QVariant::String:
+            return property.toString() + "px";
+        case QVariant::Int:
+            return QString::number(property.toInt());
+        case QVariant::UserType:
         {
-            case QVariant::String:
-                style = style.arg(property.toString() + "px");
-                break;
-            case QVariant::Int:
-                style = style.arg(property.toInt());
+            const Colors& colors = property.value<Colors>();
+            if(colors.size() == 0)
+                throw std::runtime_error("Some property has no colors!");
+            return FormatColor(colors);
+        }
+        default:
+            throw std::runtime_error("Unknown property type in style!");
+    }
+}
+
+//Style sheet split once into literal spans and %Property% slots,
+//so that filling it with StyleParams is a single pass over the tokens.
+class StyleSheetTemplate
+{
+public:
+    explicit StyleSheetTemplate(const QString& sheet) : source(sheet)
+    {
+        int literalStart = 0;
+        int pos = 0;
+        while((pos = source.indexOf('%', pos)) != -1)
+        {
+            const int nameEnd = source.indexOf('%', pos + 1);
+            if(nameEnd == -1)
                 break;
-            case QVariant::UserType:
+            if(!IsPropertyName(pos + 1, nameEnd))
             {
-                const Colors& colors = property.value<Colors>();
-                if(colors.size() == 0)
-                    throw std::runtime_error("Some property has no colors!");
-                style = style.arg(FormatColor(colors));
-                break;
+                pos = nameEnd;
+                continue;
+            }
+
+            if(pos > literalStart)
+                tokens.push_back({literalStart, pos - literalStart, -1});
+
+            const QByteArray name = source.mid(pos + 1, nameEnd - pos - 1).toLatin1();
+            int slot = slotNames.indexOf(name);
+            if(slot == -1)
+            {
+                slot = slotNames.size();
+                slotNames.append(name);
             }
-            default:
-                throw std::runtime_error("Unknown property type in style!");
+            tokens.push_back({pos, nameEnd - pos + 1, slot});
+            pos = literalStart = nameEnd + 1;
         }
+        if(literalStart < source.size())
+            tokens.push_back({literalStart, source.size() - literalStart, -1});
     }
+
+    //Property value for every slot, null string if the slot has to stay as is
+    QVector<QString> ResolveSlots(const StyleParams& params) const
+    {
+        const QMetaObject* metaObject = params.metaObject();
+        QVector<QString> values(slotNames.size());
+        for(int i=0; i<slotNames.size(); i++)
+        {
+            const int propIndex = metaObject->indexOfProperty(slotNames[i].constData());
+            if(propIndex == -1)
+                continue;
+            const QMetaProperty prop = metaObject->property(propIndex);
+            if(QString(prop.name()) == "objectName" || prop.type() == QVariant::Bool)
+                continue;
+            values[i] = FormatProperty(prop, params.property(prop.name()));
+        }
+        return values;
+    }
+
+    int RenderedSize(const QVector<QString>& values) const
+    {
+        int size = 0;
+        for(const Token& token : tokens)
+            size += (token.slot == -1 || values[token.slot].isNull()) ? token.length : values[token.slot].size();
+        return size;
+    }
+
+    void Render(const QVector<QString>& values, QString& out) const
+    {
+        for(const Token& token : tokens)
+        {
+            if(token.slot == -1 || values[token.slot].isNull())
+                out.append(source.constData() + token.offset, token.length);
+            else
+                out.append(values[token.slot]);
+        }
+    }
+
+private:
+    struct Token
+    {
+        int offset;
+        int length;
+        int slot; //index in slotNames, -1 for literal text
+    };
+
+    bool IsPropertyName(int from, int to) const
+    {
+        if(from == to)
+            return false;
+        for(int i=from; i<to; i++)
+        {
+            const QChar c = source[i];
+            if(!(c.isLetterOrNumber() || c == '_') || c.unicode() > 127)
+                return false;
+        }
+        return true;
+    }
+
+    QString            source;
+    std::vector<Token> tokens;
+    QList<QByteArray>  slotNames;
+};
+
+static const StyleSheetTemplate& GetStyleTemplate()
+{
+    static const StyleSheetTemplate styleTemplate = []
+    {
+        QFile f(":/tt/StyleTemplate.qss");
+        f.open(QFile::ReadOnly);
+        return StyleSheetTemplate(QString(f.readAll()));
+    }();
+    return styleTemplate;
+}
+
+static void FillStyle(QString& style, const StyleParams& params)
+{
+    style.clear();
+
+    const StyleSheetTemplate* styleTemplate = params.UseTemplateSheet ? &GetStyleTemplate() : nullptr;
+    const StyleSheetTemplate additionalSheet(params.AdditionalStyleSheet);
+
+    QVector<QString> templateValues;
+    int size = 0;
+    if(styleTemplate)
+    {
+        templateValues = styleTemplate->ResolveSlots(params);
+        size += styleTemplate->RenderedSize(templateValues);
+    }
+    const QVector<QString> additionalValues = additionalSheet.ResolveSlots(params);
+    size += additionalSheet.RenderedSize(additionalValues);
+
+    style.reserve(size);
+    if(styleTemplate)
+        styleTemplate->Render(templateValues, style);
+    additionalSheet.Render(additionalValues, style);
 }
 
 bool IsStyleRegistered(const QString& styleName)
@@ -138,6 +267,30 @@ QString GetSheetForStyle(const StyleParams& style)
     return styleString;
 }
 
+QString GetSheetForProperty(const QString& sheet, const QString& property)
+{
+    //keep only rules whose selectors refer to given property
+    const QString marker = "[" + property + "=\"true\"]";
+    QString result;
+    int pos = 0;
+    while(pos < sheet.size())
+    {
+        const int open = sheet.indexOf('{', pos);
+        if(open == -1)
+            break;
+        int close = sheet.indexOf('}', open);
+        if(close == -1)
+            close = sheet.size() - 1;
+        if(sheet.mid(pos, open - pos).contains(marker))
+        {
+            result += sheet.mid(pos, close - pos + 1).trimmed();
+            result += '\n';
+        }
+        pos = close + 1;
+    }
+    return result;
+}
+
 void RegisterStyle(const QString& styleName, const TStyleCreator& creator)
 {
     if(!styleMap)
@@ -151,6 +304,53 @@ void RegisterStyle(const QString& styleName, const TStyleCreator& creator)
 void UnregisterStyle(const QString& styleName)
 {
     styleMap->remove(styleName);
+    RemoveCachedStyle(styleName);
+}
+
+CachedStyle GetCachedStyle(const QString& styleName)
+{
+    StyleCache& cache = GetStyleCache();
+    const QPair<QString, uint> key(styleName, GetPaletteFingerprint());
+    auto cached = cache.styles.constFind(key);
+    if(cached != cache.styles.constEnd())
+    {
+        cache.stats.hits++;
+        return *cached;
+    }
+
+    cache.stats.misses++;
+    CachedStyle style;
+    style.params.reset(CreateStyle(styleName).release());
+    style.sheet = GetSheetForStyle(*style.params);
+    cache.styles.insert(key, style);
+    return style;
+}
+
+QString GetCachedSheetForStyle(const QString& styleName)
+{
+    return GetCachedStyle(styleName).sheet;
+}
+
+uint GetPaletteFingerprint()
+{
+    //roles that default styles are built from
+    static const QPalette::ColorRole roles[] = {QPalette::Light, QPalette::Midlight, QPalette::Dark, QPalette::Window,
+                                                QPalette::Text, QPalette::Highlight, QPalette::HighlightedText};
+    const QPalette palette;
+    uint fingerprint = 0;
+    for(QPalette::ColorRole role : roles)
+        fingerprint = fingerprint * 31 + qHash(palette.color(role).rgba());
+    return fingerprint;
+}
+
+StyleCacheStats GetStyleCacheStats()
+{
+    return GetStyleCache().stats;
+}
+
+void ClearStyleCache()
+{
+    GetStyleCache() = StyleCache();
 }
 
 QStringList GetRegisteredStyles()
@@ -180,15 +380,47 @@ QString GetDefaultStyle()
 
 float GetScaleFactor(const QWidget& widget)
 {
+    if(const QWindow* window = widget.window()->windowHandle())
+        if(const QScreen* scr = window->screen())
+            return GetScaleFactor(*scr);
+
 #if (QT_VERSION <= QT_VERSION_CHECK(5, 10, 0))
     auto scrNumber = QApplication::desktop()->screenNumber(widget.mapToGlobal(QPoint(0,0)));
     auto screens = QGuiApplication::screens();
-    QScreen* scr = screens.at(scrNumber);
+    QScreen* scr = (scrNumber >= 0 && scrNumber < screens.size() ? screens.at(scrNumber) : nullptr);
 #else
     QScreen* scr = QGuiApplication::screenAt(widget.mapToGlobal(QPoint(0,0)));
 #endif
-    const float defaultDpi = 96.0f;
-    return scr->logicalDotsPerInchY() / defaultDpi;
+    if(!scr)
+        scr = QGuiApplication::primaryScreen();
+    return GetScaleFactor(*scr);
+}
+
+float GetScaleFactor(const QScreen& screen)
+{
+    static QHash<const QScreen*, float> scaleFactors;
+    auto computeScale = [](const QScreen& scr)
+    {
+        const float defaultDpi = 96.0f;
+        return float(scr.logicalDotsPerInchY() / defaultDpi);
+    };
+
+    auto cached = scaleFactors.constFind(&screen);
+    if(cached != scaleFactors.constEnd())
+        return *cached;
+
+    const float scale = computeScale(screen);
+    scaleFactors.insert(&screen, scale);
+    QScreen* scr = const_cast<QScreen*>(&screen);
+    QObject::connect(scr, &QScreen::logicalDotsPerInchChanged, [scr, computeScale]()
+    {
+        scaleFactors[scr] = computeScale(*scr);
+    });
+    QObject::connect(scr, &QObject::destroyed, [scr]()
+    {
+        scaleFactors.remove(scr);
+    });
+    return scale;
 }
 
 int GetPixelMetric(QStyle::PixelMetric metric)
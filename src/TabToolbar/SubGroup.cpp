@@ -20,15 +20,24 @@
 #include <QSize>
 #include <QScreen>
 #include <QSpacerItem>
-#include <stdexcept>
+#include <TabToolbar/Page.h>
 #include <TabToolbar/Styles.h>
 #include <TabToolbar/StyleTools.h>
 #include <TabToolbar/SubGroup.h>
 #include <TabToolbar/TabToolbar.h>
+#include <TabToolbar/ToolbarContext.h>
+#include "ButtonStrip.h"
 
 using namespace tt;
 
-SubGroup::SubGroup(Align align, QWidget* parent) : QFrame(parent)
+SubGroup::SubGroup(Align align, QWidget* parent) :
+    SubGroup(align, FindToolbarContext(parent), parent)
+{
+}
+
+SubGroup::SubGroup(Align align, const std::shared_ptr<ToolbarContext>& _context, QWidget* parent) :
+    QFrame(parent),
+    context(_context)
 {
     setFrameShape(NoFrame);
     setLineWidth(0);
@@ -47,7 +56,16 @@ SubGroup::SubGroup(Align align, QWidget* parent) : QFrame(parent)
 
 void SubGroup::AddAction(QToolButton::ToolButtonPopupMode type, QAction* action, QMenu* menu)
 {
-    const int iconSize = GetPixelMetric(QStyle::PM_SmallIconSize) * GetScaleFactor(*this);
+    if(owner)
+        owner->GroupChanged();
+    if(context->paintedButtons)
+    {
+        ButtonStrip* strip = PaintedRows();
+        strip->AddButton(ButtonStrip::Kind::Small, type, action, menu, strip->RowCount());
+        return;
+    }
+
+    const int iconSize = GetPixelMetric(QStyle::PM_SmallIconSize) * context->scaleFactor;
     QFrame* frame = ConstructInnerFrame(0);
 
     QToolButton* btn = new QToolButton(this);
@@ -57,6 +75,7 @@ void SubGroup::AddAction(QToolButton::ToolButtonPopupMode type, QAction* action,
     btn->setDefaultAction(action);
     btn->setPopupMode(type);
     btn->setIconSize(QSize(iconSize, iconSize));
+    btn->setProperty("TTIconMetric", QVariant(int(QStyle::PM_SmallIconSize)));
     if(menu)
         btn->setMenu(menu);
     btn->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Preferred);
@@ -67,16 +86,30 @@ void SubGroup::AddAction(QToolButton::ToolButtonPopupMode type, QAction* action,
 
 void SubGroup::AddWidget(QWidget* widget)
 {
+    if(owner)
+        owner->GroupChanged();
     QFrame* frame = ConstructInnerFrame(4);
     widget->setParent(frame);
     widget->setProperty("TTInternal", QVariant(true));
+    widget->setProperty("TTCustomWidget", QVariant(true));
     frame->layout()->addWidget(widget);
     innerLayout->insertWidget(innerLayout->count()-1, frame);
 }
 
 void SubGroup::AddHorizontalButtons(const std::vector<ActionParams>& params)
 {
-    const int iconSize = GetPixelMetric(QStyle::PM_SmallIconSize) * GetScaleFactor(*this);
+    if(owner)
+        owner->GroupChanged();
+    if(context->paintedButtons)
+    {
+        ButtonStrip* strip = PaintedRows();
+        const int row = strip->RowCount();
+        for(auto& param : params)
+            strip->AddButton(ButtonStrip::Kind::IconOnly, param.type, param.action, param.menu, row);
+        return;
+    }
+
+    const int iconSize = GetPixelMetric(QStyle::PM_SmallIconSize) * context->scaleFactor;
     QFrame* frame = ConstructInnerFrame(0);
     frame->setProperty("TTHorizontalFrame", QVariant(true));
 
@@ -89,6 +122,7 @@ void SubGroup::AddHorizontalButtons(const std::vector<ActionParams>& params)
         btn->setDefaultAction(param.action);
         btn->setPopupMode(param.type);
         btn->setIconSize(QSize(iconSize, iconSize));
+        btn->setProperty("TTIconMetric", QVariant(int(QStyle::PM_SmallIconSize)));
         if(param.menu)
             btn->setMenu(param.menu);
         btn->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
@@ -98,16 +132,34 @@ void SubGroup::AddHorizontalButtons(const std::vector<ActionParams>& params)
     innerLayout->insertWidget(innerLayout->count()-1, frame);
 }
 
-QFrame* SubGroup::ConstructInnerFrame(int spacing)
+void SubGroup::SetContext(const std::shared_ptr<ToolbarContext>& newContext)
 {
+    context = newContext;
+    for(int i=0; i<innerLayout->count(); i++)
+        if(QWidget* frame = innerLayout->itemAt(i)->widget())
+        {
+            if(ButtonStrip* strip = qobject_cast<ButtonStrip*>(frame))
+                strip->SetContext(context);
+            else
+                frame->setMaximumHeight(context->groupMaxHeight / context->rowCount);
+        }
+}
 
-    const auto* parentTT = _FindTabToolbarParent(*this);
-    if (!parentTT)
-        throw std::runtime_error("Group should be constructed inside TabToolbar!");
-
-    unsigned groupMaxHeight = parentTT->GroupMaxHeight();
-    unsigned rowCount = parentTT->RowCount();
+ButtonStrip* SubGroup::PaintedRows()
+{
+    //consecutive buttons share one strip, custom widgets in between start a new one
+    const int last = innerLayout->count() - 2;
+    if(last >= 0)
+        if(ButtonStrip* strip = qobject_cast<ButtonStrip*>(innerLayout->itemAt(last)->widget()))
+            return strip;
+
+    ButtonStrip* strip = new ButtonStrip(Qt::Vertical, context, this);
+    innerLayout->insertWidget(innerLayout->count()-1, strip);
+    return strip;
+}
 
+QFrame* SubGroup::ConstructInnerFrame(int spacing)
+{
     QFrame* frame = new QFrame(this);
     frame->setFrameShape(QFrame::NoFrame);
     frame->setLineWidth(0);
@@ -116,7 +168,7 @@ QFrame* SubGroup::ConstructInnerFrame(int spacing)
     policy.setHorizontalStretch(0);
     policy.setVerticalStretch(1);
     frame->setSizePolicy(policy);
-    frame->setMaximumHeight(groupMaxHeight / rowCount);
+    frame->setMaximumHeight(context->groupMaxHeight / context->rowCount);
     QHBoxLayout* l = new QHBoxLayout(frame);
     l->setMargin(0);
     l->setContentsMargins(0, 0, 0, 0);
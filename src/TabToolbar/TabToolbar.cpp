@@ -25,22 +25,88 @@
 #include <QFrame>
 #include <QTimer>
 #include <QScreen>
+#include <QWindow>
+#include <QCursor>
+#include <QElapsedTimer>
+#include <QVBoxLayout>
+#include <algorithm>
 #include <stdexcept>
 #include <TabToolbar/TabToolbar.h>
 #include <TabToolbar/Page.h>
 #include <TabToolbar/Styles.h>
 #include <TabToolbar/StyleTools.h>
+#include <TabToolbar/ToolbarContext.h>
+#include "NativeStyle.h"
+#include "ToolButtonStyle.h"
 
 using namespace tt;
 
+namespace
+{
+//pages are built from event loop slots, which exceptions of group creators must not leave;
+//returns whether page has more groups to build
+bool MaterializeNoThrow(Page& page, bool nextGroupOnly)
+{
+    try
+    {
+        if(nextGroupOnly)
+            return page.MaterializeNext();
+        page.Materialize();
+    }
+    catch(const std::exception& e)
+    {
+        qWarning("TabToolbar: could not build page \"%s\": %s", qPrintable(page.objectName()), e.what());
+    }
+    catch(...)
+    {
+        qWarning("TabToolbar: could not build page \"%s\"", qPrintable(page.objectName()));
+    }
+    return false;
+}
+
+//widgets which are styled by toolbar itself, user widgets are left untouched
+bool IsToolbarStyled(const QWidget* widget)
+{
+    static const char* const properties[] = {"TabToolbar", "TTWidget", "TTTab", "TTHide", "TTPage",
+                                             "TTGroupName", "TTSeparator", "TTHorizontalFrame"};
+    for(const char* property : properties)
+        if(widget->property(property).toBool())
+            return true;
+    return false;
+}
+
+//leaf widgets which may carry a style sheet without passing it on to user widgets
+const char* ScopedSheetProperty(const QWidget* widget)
+{
+    static const char* const properties[] = {"TTTab", "TTHide", "TTGroupName", "TTSeparator", "TTHorizontalFrame"};
+    for(const char* property : properties)
+        if(widget->property(property).toBool())
+            return property;
+    return nullptr;
+}
+}
+
 TabToolbar::TabToolbar(QWidget* parent, unsigned _groupMaxHeight, unsigned _groupRowCount) :
     QToolBar(parent),
     groupRowCount(_groupRowCount),
-    groupMaxHeight(_groupMaxHeight)
+    groupMaxHeight(_groupMaxHeight),
+    buttonStyle(TTToolButtonStyle::GetShared()),
+    context(std::make_shared<ToolbarContext>())
 {
+    context->toolbar = this;
+    context->rowCount = groupRowCount;
+    context->buttonStyle = buttonStyle;
+    UpdateContext();
+
     setObjectName("TabToolbar");
     tempShowTimer.setSingleShot(true);
     tempShowTimer.setInterval(QApplication::doubleClickInterval());
+    // style and palette changes come in bursts (and on KDE new palette is not ready yet), wait
+    restyleTimer.setSingleShot(true);
+    restyleTimer.setInterval(50);
+    QObject::connect(&restyleTimer, &QTimer::timeout, this, &TabToolbar::Restyle);
+    materializeTimer.setInterval(0);
+    QObject::connect(&materializeTimer, &QTimer::timeout, this, &TabToolbar::MaterializeSlice);
 
     setProperty("TabToolbar", QVariant(true));
     layout()->setContentsMargins(0, 0, 0, 0);
@@ -83,6 +149,7 @@ TabToolbar::TabToolbar(QWidget* parent, unsigned _groupMaxHeight, unsigned _grou
         isMinimized = hideAction->isChecked();
         hideAction->setText(isMinimized ? "▼" : "▲");
         HideAt(tabBar->currentIndex());
+        UpdateFocusTracking();
         if(isMinimized)
             emit Minimized();
         else
@@ -91,7 +158,6 @@ TabToolbar::TabToolbar(QWidget* parent, unsigned _groupMaxHeight, unsigned _grou
     QObject::connect(tabBar, &QTabWidget::tabBarDoubleClicked, hideAction, &QAction::trigger);
     QObject::connect(tabBar, &QTabWidget::tabBarClicked, this, &TabToolbar::TabClicked);
     QObject::connect(tabBar, &QTabWidget::currentChanged, this, &TabToolbar::CurrentTabChanged);
-    QObject::connect((QApplication*)QApplication::instance(), &QApplication::focusChanged, this, &TabToolbar::FocusChanged);
     cornerLayout->addWidget(hideButton);
     tabBar->setCornerWidget(cornerActions);
 
@@ -100,19 +166,117 @@ TabToolbar::TabToolbar(QWidget* parent, unsigned _groupMaxHeight, unsigned _grou
 
 TabToolbar::~TabToolbar()
 {
+    // pages outlive the registry when children are deleted by QWidget
+    for(Page* page : pages)
+        if(page)
+            QObject::disconnect(page, &QObject::destroyed, this, nullptr);
 }
 
 bool TabToolbar::event(QEvent* event)
 {
-    if(event->type() == QEvent::StyleChange && !ignoreStyleEvent)
-        QTimer::singleShot(0, this, [this]()
-        { // on KDE new palette is not ready yet, wait
-            const QString styleName = (style ? style->objectName() : GetDefaultStyle());
-            SetStyle(styleName);
-        });
+    if((event->type() == QEvent::StyleChange || event->type() == QEvent::PaletteChange) && !ignoreStyleEvent)
+        ScheduleRestyle();
+    else if(event->type() == QEvent::Show)
+        WatchScreen();
     return QToolBar::event(event);
 }
 
+void TabToolbar::ScheduleRestyle()
+{
+    if(restyleTimer.isActive())
+        skippedRestyles++;
+    restyleTimer.start();
+}
+
+void TabToolbar::Restyle()
+{
+    UpdateBaseStyles();
+    if(style && GetPaletteFingerprint() == paletteFingerprint)
+    {
+        skippedRestyles++;
+        return;
+    }
+
+    const QString styleName = (style ? style->objectName() : GetDefaultStyle());
+    SetStyle(styleName);
+}
+
+unsigned TabToolbar::SkippedRestyles() const
+{
+    return skippedRestyles;
+}
+
+void TabToolbar::UpdateBaseStyles()
+{
+    if(nativeStyle && nativeStyle->UpdateBaseStyle())
+        ApplyRenderMode(this, true);
+
+    // shared by all toolbars, so it repolishes their buttons itself
+    buttonStyle->UpdateBaseStyle();
+}
+
+std::shared_ptr<ToolbarContext> TabToolbar::Context() const
+{
+    return context;
+}
+
+void TabToolbar::UpdateContext()
+{
+    context->scaleFactor = GetScaleFactor(*this);
+    context->groupMaxHeight = groupMaxHeight * context->scaleFactor;
+}
+
+void TabToolbar::WatchScreen()
+{
+    QWindow* window = this->window()->windowHandle();
+    if(!window || window == watchedWindow)
+        return;
+
+    if(watchedWindow)
+        QObject::disconnect(watchedWindow, nullptr, this, nullptr);
+    watchedWindow = window;
+    QObject::connect(window, &QWindow::screenChanged, this, [this](QScreen* screen){ ScreenChanged(screen); });
+    ScreenChanged(window->screen());
+}
+
+void TabToolbar::ScreenChanged(QScreen* screen)
+{
+    QObject::disconnect(screenDpiConnection);
+    if(screen)
+    {
+        screenDpiConnection = QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, this, [this]()
+        { // let scale factor cache catch up first
+            QTimer::singleShot(0, this, [this](){ Rescale(); });
+        });
+    }
+    Rescale();
+}
+
+void TabToolbar::Rescale()
+{
+    const float oldScale = context->scaleFactor;
+    UpdateContext();
+    if(qFuzzyCompare(oldScale, context->scaleFactor))
+        return;
+
+    for(QToolButton* button : findChildren<QToolButton*>())
+    {
+        const QVariant metric = button->property("TTIconMetric");
+        if(!metric.isValid())
+            continue;
+        const int iconSize = GetPixelMetric(static_cast<QStyle::PixelMetric>(metric.toInt())) * context->scaleFactor;
+        button->setIconSize(QSize(iconSize, iconSize));
+        if(button->property("TTCompactIcon").toBool())
+            button->setMaximumHeight(iconSize + 5);
+    }
+
+    int groupHeight = 0;
+    for(Page* page : findChildren<Page*>())
+        groupHeight = std::max(groupHeight, page->ApplyContext());
+    if(groupHeight > 0)
+        AdjustVerticalSize(groupHeight);
+}
+
 void TabToolbar::FocusChanged(QWidget* old, QWidget* now)
 {
     (void)old;
@@ -140,14 +304,26 @@ unsigned TabToolbar::RowCount() const
 
 unsigned TabToolbar::GroupMaxHeight() const
 {
-    return groupMaxHeight * GetScaleFactor(*this);
+    return context->groupMaxHeight;
 }
 
 void TabToolbar::SetStyle(const QString& styleName)
 {
     ignoreStyleEvent = true;
-    style.reset(CreateStyle(styleName).release());
-    setStyleSheet(GetSheetForStyle(*style));
+    const CachedStyle cached = GetCachedStyle(styleName);
+    style = cached.params;
+    paletteFingerprint = GetPaletteFingerprint();
+    if(renderMode == RenderMode::StyleSheet)
+    {
+        setStyleSheet(cached.sheet);
+    }
+    else
+    {
+        nativeStyle->SetParams(style);
+        if(renderMode == RenderMode::ScopedStyleSheet)
+            UpdateScopedSheets(cached.sheet);
+        ApplyRenderMode(this, true);
+    }
     ignoreStyleEvent = false;
     emit StyleChanged();
 }
@@ -159,6 +335,113 @@ QString TabToolbar::GetStyle() const
     return "";
 }
 
+void TabToolbar::SetRenderMode(RenderMode mode)
+{
+    if(mode == renderMode)
+        return;
+
+    renderMode = mode;
+    ignoreStyleEvent = true;
+    if(renderMode == RenderMode::StyleSheet)
+    {
+        ApplyRenderMode(this, false);
+        setStyleSheet(GetCachedSheetForStyle(GetStyle()));
+    }
+    else
+    {
+        if(!nativeStyle)
+            nativeStyle.reset(new TTNativeStyle());
+        nativeStyle->SetParams(style);
+        if(renderMode == RenderMode::ScopedStyleSheet)
+            UpdateScopedSheets(GetCachedSheetForStyle(GetStyle()));
+        setStyleSheet("");
+        ApplyRenderMode(this, false);
+    }
+    ignoreStyleEvent = false;
+}
+
+TabToolbar::RenderMode TabToolbar::GetRenderMode() const
+{
+    return renderMode;
+}
+
+void TabToolbar::UpdateScopedSheets(const QString& sheet)
+{
+    scopedSheets.clear();
+    for(const char* property : {"TTTab", "TTHide", "TTGroupName", "TTSeparator", "TTHorizontalFrame"})
+        scopedSheets.insert(property, GetSheetForProperty(sheet, property));
+}
+
+void TabToolbar::ApplyRenderMode(QWidget* root, bool repolish)
+{
+    QList<QWidget*> widgets = root->findChildren<QWidget*>();
+    widgets.prepend(root);
+    for(QWidget* widget : widgets)
+    {
+        if(!IsToolbarStyled(widget))
+            continue;
+
+        //in scoped mode containers are painted natively, leaves get their part of style sheet
+        const char* sheetProperty = (renderMode == RenderMode::ScopedStyleSheet ? ScopedSheetProperty(widget) : nullptr);
+        const bool useNativeStyle = (renderMode == RenderMode::Native) ||
+                                    (renderMode == RenderMode::ScopedStyleSheet && !sheetProperty);
+        const bool hasNativeStyle = nativeStyle && widget->testAttribute(Qt::WA_SetStyle) && widget->style() == nativeStyle.get();
+        if(useNativeStyle)
+        {
+            if(!hasNativeStyle)
+            {
+                widget->setStyle(nativeStyle.get());
+            }
+            else if(repolish)
+            {
+                nativeStyle->unpolish(widget);
+                nativeStyle->polish(widget);
+                widget->update();
+            }
+        }
+        else if(hasNativeStyle)
+        {
+            widget->setStyle(nullptr);
+        }
+
+        if(widget == this)
+            continue;
+        const QString sheet = (sheetProperty ? scopedSheets.value(sheetProperty) : QString());
+        if(widget->styleSheet() != sheet)
+            widget->setStyleSheet(sheet);
+    }
+}
+
+bool TabToolbar::eventFilter(QObject* watched, QEvent* event)
+{
+    if(watched == popup)
+    {
+        if(event->type() == QEvent::Hide)
+        {
+            RestorePopupContent();
+            isShown = false;
+            UpdateFocusTracking();
+
+            // click on current tab closed the popup, it must not reopen it right away
+            const QTabBar* tabs = tabBar->tabBar();
+            ignoreTabClick = tabs->underMouse() && tabs->tabAt(tabs->mapFromGlobal(QCursor::pos())) == currentIndex;
+            if(ignoreTabClick)
+                QTimer::singleShot(0, this, [this](){ ignoreTabClick = false; });
+        }
+        return QToolBar::eventFilter(watched, event);
+    }
+
+    //pages are filled lazily, so style whatever they have by the time they are shown
+    if(event->type() == QEvent::Show && renderMode != RenderMode::StyleSheet)
+    {
+        const bool ignore = ignoreStyleEvent;
+        ignoreStyleEvent = true;
+        ApplyRenderMode(static_cast<QWidget*>(watched), false);
+        ignoreStyleEvent = ignore;
+    }
+    return QToolBar::eventFilter(watched, event);
+}
+
 void TabToolbar::AddCornerAction(QAction* action)
 {
     QToolButton* actionButton = new QToolButton(tabBar);
@@ -180,6 +463,130 @@ void TabToolbar::SetSpecialTabEnabled(bool enabled)
     }
 }
 
+void TabToolbar::SetMinimizedPopupEnabled(bool enabled)
+{
+    minimizedPopup = enabled;
+    if(!enabled && popup)
+        popup->hide();
+}
+
+bool TabToolbar::IsMinimizedPopupEnabled() const
+{
+    return minimizedPopup;
+}
+
+void TabToolbar::SetHibernationLimit(int alivePages)
+{
+    hibernationLimit = alivePages;
+    EnforceHibernationLimit();
+}
+
+int TabToolbar::HibernationLimit() const
+{
+    return hibernationLimit;
+}
+
+void TabToolbar::SetPaintedButtons(bool painted)
+{
+    context->paintedButtons = painted;
+    if(!painted || context->largeButtonProxy)
+        return;
+
+    //painted buttons borrow style and style sheet rules of these, they are never shown
+    auto createProxy = [this]()
+    {
+        QToolButton* proxy = new QToolButton(tabBar);
+        proxy->setProperty("TTInternal", QVariant(true));
+        proxy->setAutoRaise(true);
+        proxy->hide();
+        return proxy;
+    };
+    context->largeButtonProxy = createProxy();
+    context->largeButtonProxy->setStyle(buttonStyle.get());
+    context->smallButtonProxy = createProxy();
+    context->horizontalFrameProxy = new QFrame(tabBar);
+    context->horizontalFrameProxy->setProperty("TTHorizontalFrame", QVariant(true));
+    context->horizontalFrameProxy->hide();
+    ApplyRenderMode(context->horizontalFrameProxy, false);
+}
+
+bool TabToolbar::PaintedButtons() const
+{
+    return context->paintedButtons;
+}
+
+void TabToolbar::TouchPage(Page* page)
+{
+    recentPages.removeAll(page);
+    recentPages.prepend(page);
+    EnforceHibernationLimit();
+}
+
+void TabToolbar::EnforceHibernationLimit()
+{
+    recentPages.removeAll(QPointer<Page>());
+    if(hibernationLimit <= 0)
+        return;
+
+    // least recently used pages beyond the limit drop their widgets, they are rebuilt on selection
+    int alive = 0;
+    for(const QPointer<Page>& page : recentPages)
+    {
+        if(page->builtGroups == 0)
+            continue;
+        if(++alive > hibernationLimit && page != popupPage && page->Hibernate())
+            alive--;
+    }
+}
+
+void TabToolbar::MaterializeAsync(int sliceMs)
+{
+    materializeSliceMs = std::max(1, sliceMs);
+    materializeQueue.clear();
+    if(Page* current = static_cast<Page*>(tabBar->currentWidget()))
+        materializeQueue.append(current);
+    // with hibernation enabled pages stay lazy, building them ahead would be undone right away
+    if(hibernationLimit <= 0)
+        for(const QPointer<Page>& page : pages)
+            if(page && page != tabBar->currentWidget())
+                materializeQueue.append(page);
+    materializeTimer.start();
+}
+
+bool TabToolbar::IsMaterializing() const
+{
+    return materializeTimer.isActive();
+}
+
+void TabToolbar::MaterializeSlice()
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    {
+        TabToolbarUpdateGuard updateGuard(this);
+        while(!materializeQueue.isEmpty() && elapsed.elapsed() < materializeSliceMs)
+        {
+            Page* page = materializeQueue.first();
+            if(!page || !MaterializeNoThrow(*page, true))
+                materializeQueue.removeFirst();
+        }
+    }
+
+    // pages may also be built or hibernated by tab switches in between slices
+    int built = 0;
+    int total = 0;
+    for(const QPointer<Page>& page : pages)
+    {
+        if(!page)
+            continue;
+        built += int(page->builtGroups);
+        total += int(page->deferredGroups.size());
+    }
+    if(materializeQueue.isEmpty())
+        materializeTimer.stop();
+    emit MaterializeProgress(built, total);
+}
+
 QAction* TabToolbar::HideAction()
 {
     return hideAction;
@@ -187,6 +594,11 @@ QAction* TabToolbar::HideAction()
 
 void TabToolbar::TabClicked(int index)
 {
+    if(ignoreTabClick)
+    {
+        ignoreTabClick = false;
+        return;
+    }
     if(tempShowTimer.isActive() || (index == 0 && hasSpecialTab))
         return;
 
@@ -197,6 +609,7 @@ void TabToolbar::TabClicked(int index)
         isMinimized = isShown;
         HideAt(index);
         isMinimized = true;
+        UpdateFocusTracking();
     }
 }
 
@@ -211,6 +624,11 @@ void TabToolbar::CurrentTabChanged(int index)
     else
     {
         currentIndex = index;
+        if(Page* page = static_cast<Page*>(tabBar->widget(index)))
+        {
+            MaterializeNoThrow(*page, false);
+            TouchPage(page);
+        }
     }
 }
 
@@ -224,19 +642,41 @@ void TabToolbar::SetCurrentTab(int index)
     tabBar->setCurrentIndex(index);
 }
 
+Page* TabToolbar::CurrentPage() const
+{
+    return static_cast<Page*>(tabBar->currentWidget());
+}
+
+void TabToolbar::SetCurrentPage(Page* page)
+{
+    const int index = tabBar->indexOf(page);
+    if(index >= 0)
+        tabBar->setCurrentIndex(index);
+}
+
 void TabToolbar::HideAt(int index)
 {
     if(isMinimized)
     {
+        isShown = false;
+        if(popup && popup->isVisible())
+        {
+            popup->hide();
+            return;
+        }
         const int minHeight = tabBar->tabBar()->height() + 2;
         tabBar->setMaximumHeight(minHeight);
         tabBar->setMinimumHeight(minHeight);
         setMaximumHeight(minHeight);
         setMinimumHeight(minHeight);
-        isShown = false;
     } else {
         tabBar->setCurrentIndex(index);
-        if(!isShown)
+        if(!isShown && minimizedPopup && hideAction->isChecked())
+        {
+            // peek at minimized page without resizing toolbar
+            ShowPopup(index);
+        }
+        else if(!isShown)
         {
             tabBar->setMaximumHeight(maxHeight);
             tabBar->setMinimumHeight(maxHeight);
@@ -247,49 +687,433 @@ void TabToolbar::HideAt(int index)
         setFocus();
         isShown = true;
     }
+    UpdateFocusTracking();
+}
+
+// focus is only interesting while a minimized page is shown,
+// so toolbar does not listen to application wide focus traffic otherwise
+void TabToolbar::UpdateFocusTracking()
+{
+    const bool track = isMinimized && isShown;
+    if(track == bool(focusConnection))
+        return;
+
+    if(track)
+        focusConnection = QObject::connect((QApplication*)QApplication::instance(), &QApplication::focusChanged,
+                                           this, &TabToolbar::FocusChanged);
+    else
+    {
+        QObject::disconnect(focusConnection);
+        focusConnection = QMetaObject::Connection();
+    }
+}
+
+void TabToolbar::ShowPopup(int index)
+{
+    Page* page = static_cast<Page*>(tabBar->widget(index));
+    if(!page)
+        return;
+    MaterializeNoThrow(*page, false);
+    TouchPage(page);
+
+    if(!popup)
+    {
+        popup = new QFrame(this, Qt::Popup);
+        popup->setFrameShape(QFrame::NoFrame);
+        popup->setContentsMargins(0, 0, 0, 0);
+        QVBoxLayout* popupLayout = new QVBoxLayout(popup);
+        popupLayout->setContentsMargins(0, 0, 0, 0);
+        popupLayout->setSpacing(0);
+        popup->setLayout(popupLayout);
+        popup->installEventFilter(this);
+    }
+
+    RestorePopupContent();
+    popupPage = page;
+    popup->layout()->addWidget(page->scrollArea);
+    page->scrollArea->show();
+
+    const QTabBar* tabs = tabBar->tabBar();
+    const QPoint topLeft = tabBar->mapToGlobal(QPoint(0, tabs->geometry().bottom() + 1));
+    popup->setGeometry(QRect(topLeft, QSize(tabBar->width(), PopupHeight())));
+    popup->show();
+}
+
+int TabToolbar::PopupHeight() const
+{
+    // height of a page built right before it is shown is still pending
+    if(pendingGroupHeight > 0)
+        return int(pendingGroupHeight) + 4;
+    return std::max(0, int(maxHeight) - tabBar->tabBar()->height() - 2);
+}
+
+void TabToolbar::RestorePopupContent()
+{
+    if(!popupPage)
+        return;
+
+    popupPage->layout()->addWidget(popupPage->scrollArea);
+    popupPage->scrollArea->show();
+    popupPage = nullptr;
 }
 
 void TabToolbar::HideTab(int index)
 {
-    (void)index;
-    Page* page = static_cast<Page*>(sender());
-    QSignalBlocker blocker(page);
-    for(int i=0; i<tabBar->count(); i++)
+    SetPageVisible(index, false);
+}
+
+Page* TabToolbar::GetPage(int id) const
+{
+    if(id < 0 || id >= int(pages.size()))
+        return nullptr;
+    return pages[id];
+}
+
+bool TabToolbar::IsPageVisible(int id) const
+{
+    return id >= 0 && id < int(pages.size()) && pageVisible[id];
+}
+
+void TabToolbar::SetPageVisible(int id, bool visible)
+{
+    ApplyPageVisibility(id, visible);
+    currentIndex = tabBar->currentIndex();
+}
+
+void TabToolbar::SetPagesVisible(const QSet<int>& ids, bool visible)
+{
+    ApplyPagesBatch([&]()
+    {
+        for(int id : ids)
+            ApplyPageVisibility(id, visible);
+    });
+}
+
+void TabToolbar::AddContext(const QString& contextName, const QColor& color)
+{
+    auto it = tabContextIndices.constFind(contextName);
+    if(it != tabContextIndices.constEnd())
+    {
+        TabContext& tabContext = tabContexts[it.value()];
+        tabContext.color = color;
+        for(int id : tabContext.pages)
+            if(pageVisible[id])
+                ApplyContextColor(id, VisiblePagesBefore(id));
+        return;
+    }
+
+    TabContext tabContext;
+    tabContext.name = contextName;
+    tabContext.color = color;
+    tabContextIndices.insert(contextName, tabContexts.size());
+    tabContexts.append(tabContext);
+}
+
+void TabToolbar::SetActiveContexts(const QStringList& contextNames)
+{
+    // called on every selection change, so only contexts that actually toggle touch the tab widget
+    QVector<bool> wanted(tabContexts.size(), false);
+    for(const QString& contextName : contextNames)
+    {
+        auto it = tabContextIndices.constFind(contextName);
+        if(it != tabContextIndices.constEnd())
+            wanted[it.value()] = true;
+    }
+
+    bool changed = false;
+    for(int i=0; i<tabContexts.size() && !changed; i++)
+        changed = (tabContexts.at(i).active != wanted.at(i));
+    if(!changed)
+        return;
+
+    ApplyPagesBatch([&]()
     {
-        if(tabBar->widget(i) == page)
+        // hide first, so that current tab is not moved by tabs that are about to appear
+        for(int pass=0; pass<2; pass++)
         {
-            tabBar->removeTab(i);
-            return;
+            const bool visible = (pass == 1);
+            for(int i=0; i<tabContexts.size(); i++)
+            {
+                TabContext& tabContext = tabContexts[i];
+                if(tabContext.active == wanted.at(i) || wanted.at(i) != visible)
+                    continue;
+                tabContext.active = visible;
+                for(int id : tabContext.pages)
+                    ApplyPageVisibility(id, visible);
+            }
         }
+    });
+}
+
+QStringList TabToolbar::ActiveContexts() const
+{
+    QStringList result;
+    for(const TabContext& tabContext : tabContexts)
+        if(tabContext.active)
+            result.append(tabContext.name);
+    return result;
+}
+
+void TabToolbar::ApplyPagesBatch(const std::function<void()>& apply)
+{
+    const QWidget* current = tabBar->currentWidget();
+    {
+        // tab widget would report every intermediate current tab otherwise
+        QSignalBlocker blocker(tabBar);
+        tabBar->setUpdatesEnabled(false);
+        apply();
+        tabBar->setUpdatesEnabled(true);
+    }
+
+    if(tabBar->currentWidget() != current)
+        CurrentTabChanged(tabBar->currentIndex());
+    else
+        currentIndex = tabBar->currentIndex();
+}
+
+bool TabToolbar::ApplyPageVisibility(int id, bool visible)
+{
+    Page* page = GetPage(id);
+    if(!page || bool(pageVisible[id]) == visible)
+        return false;
+
+    QSignalBlocker blocker(page);
+    const int position = VisiblePagesBefore(id);
+    if(visible)
+        tabBar->insertTab(position, page, page->objectName());
+    else
+        tabBar->removeTab(position);
+    pageVisible[id] = visible;
+    UpdateVisiblePages(id, visible ? 1 : -1);
+    if(visible)
+        ApplyContextColor(id, position);
+    return true;
+}
+
+void TabToolbar::ApplyContextColor(int id, int position)
+{
+    const int contextIndex = pageContexts[id];
+    if(contextIndex < 0)
+        return;
+    // invalid color resets tab to style's font color
+    tabBar->tabBar()->setTabTextColor(position, tabContexts.at(contextIndex).color);
+}
+
+// visible pages are counted in a Fenwick tree indexed by page position,
+// so tab position of a page is a prefix sum regardless of how many pages are hidden
+void TabToolbar::UpdateVisiblePages(int id, int delta)
+{
+    for(std::size_t i = pagePositions[id] + 1; i < visiblePagesTree.size(); i += i & (~i + 1))
+        visiblePagesTree[i] += delta;
+}
+
+int TabToolbar::VisiblePagesBefore(int id) const
+{
+    return VisibleBeforePosition(pagePositions[id]);
+}
+
+int TabToolbar::VisibleBeforePosition(std::size_t position) const
+{
+    int count = 0;
+    for(std::size_t i = position; i > 0; i -= i & (~i + 1))
+        count += visiblePagesTree[i];
+    return count;
+}
+
+void TabToolbar::InsertPageOrder(int id, int position)
+{
+    if(position == int(pageOrder.size()))
+    {
+        pageOrder.push_back(id);
+        pagePositions[id] = position;
+        // grow the tree by one node covering (i - lowbit(i), i]
+        const std::size_t i = visiblePagesTree.size();
+        const std::size_t lowBit = i & (~i + 1);
+        visiblePagesTree.push_back(pageVisible[id] + VisibleBeforePosition(i - 1) - VisibleBeforePosition(i - lowBit));
+        return;
+    }
+
+    pageOrder.insert(pageOrder.begin() + position, id);
+    for(std::size_t i = position; i < pageOrder.size(); i++)
+        pagePositions[pageOrder[i]] = int(i);
+    RebuildVisiblePages();
+}
+
+// registry does not grow with pages created and deleted over time, ids of deleted pages are reused
+void TabToolbar::ReleasePage(int id)
+{
+    const int position = pagePositions[id];
+    pageOrder.erase(pageOrder.begin() + position);
+    for(std::size_t i = position; i < pageOrder.size(); i++)
+        pagePositions[pageOrder[i]] = int(i);
+    pageVisible[id] = 0;
+    RebuildVisiblePages();
+
+    if(pageContexts[id] >= 0)
+    {
+        tabContexts[pageContexts[id]].pages.removeOne(id);
+        pageContexts[id] = -1;
+    }
+
+    if(id + 1 < int(pages.size()))
+    {
+        freePageIds.push_back(id);
+        return;
+    }
+
+    // trailing ids are dropped, so that the registry shrinks back
+    pages.pop_back();
+    while(!pages.empty() && !pages.back() &&
+          std::find(freePageIds.begin(), freePageIds.end(), int(pages.size() - 1)) != freePageIds.end())
+    {
+        freePageIds.erase(std::find(freePageIds.begin(), freePageIds.end(), int(pages.size() - 1)));
+        pages.pop_back();
+    }
+    pageVisible.resize(pages.size());
+    pageContexts.resize(pages.size());
+    pagePositions.resize(pages.size());
+}
+
+void TabToolbar::RebuildVisiblePages()
+{
+    const std::size_t count = pageOrder.size();
+    visiblePagesTree.assign(count + 1, 0);
+    for(std::size_t i = 1; i <= count; i++)
+    {
+        visiblePagesTree[i] += pageVisible[pageOrder[i - 1]];
+        const std::size_t parent = i + (i & (~i + 1));
+        if(parent <= count)
+            visiblePagesTree[parent] += visiblePagesTree[i];
     }
-    currentIndex = tabBar->currentIndex();
 }
 
 void TabToolbar::AdjustVerticalSize(unsigned vSize)
 {
-    QTimer::singleShot(0, this, [this, vSize]()
+    pendingGroupHeight = std::max(pendingGroupHeight, vSize);
+    if(updateDepth == 0)
+        ScheduleVerticalSizeUpdate();
+}
+
+void TabToolbar::ScheduleVerticalSizeUpdate()
+{
+    if(verticalSizeScheduled)
+        return;
+
+    verticalSizeScheduled = true;
+    QTimer::singleShot(0, this, [this]()
     {
-		maxHeight = vSize + tabBar->tabBar()->height() + 6;
-        setMaximumHeight(maxHeight);
-        setMinimumHeight(maxHeight);
+        verticalSizeScheduled = false;
+        if(updateDepth > 0 || pendingGroupHeight == 0)
+            return; // EndUpdate will reschedule
+
+        maxHeight = pendingGroupHeight + tabBar->tabBar()->height() + 6;
+        pendingGroupHeight = 0;
+        ApplyMaxHeight();
     });
 }
 
+// pages built while toolbar is minimized (lazy pages, hibernated ones, model edits, rescaling)
+// must not expand it, new height is only remembered for the time it is shown
+void TabToolbar::ApplyMaxHeight()
+{
+    // popup peeking at a minimized page grows instead of the toolbar
+    const bool popupShown = popup && popup->isVisible();
+    if(popupShown)
+        popup->resize(popup->width(), PopupHeight());
+    if(isMinimized && (!isShown || popupShown))
+        return;
+
+    if(tabBar->maximumHeight() != QWIDGETSIZE_MAX)
+    {
+        tabBar->setMaximumHeight(maxHeight);
+        tabBar->setMinimumHeight(maxHeight);
+    }
+    setMaximumHeight(maxHeight);
+    setMinimumHeight(maxHeight);
+}
+
+void TabToolbar::BeginUpdate()
+{
+    if(updateDepth++ == 0)
+        setUpdatesEnabled(false);
+}
+
+void TabToolbar::EndUpdate()
+{
+    if(updateDepth == 0 || --updateDepth > 0)
+        return;
+
+    setUpdatesEnabled(true);
+    if(pendingGroupHeight > 0)
+        ScheduleVerticalSizeUpdate();
+}
+
 void TabToolbar::ShowTab(int index)
 {
-    Page* page = static_cast<Page*>(sender());
-    QSignalBlocker blocker(page);
-    tabBar->insertTab(index, page, page->objectName());
-    currentIndex = tabBar->currentIndex();
+    SetPageVisible(index, true);
 }
 
 Page* TabToolbar::AddPage(const QString& pageName)
 {
-    Page* page = new Page(tabBar->count(), pageName);
+    return InsertPage(nullptr, pageName);
+}
+
+Page* TabToolbar::AddPage(const QString& pageName, const QString& contextName)
+{
+    return InsertPage(nullptr, pageName, contextName);
+}
+
+Page* TabToolbar::InsertPage(Page* before, const QString& pageName)
+{
+    UpdateContext();
+    // page order is kept apart from page ids, so inserted page does not disturb the others
+    const bool known = before && before->Id() < int(pages.size()) && pages[before->Id()] == before;
+    const int position = known ? pagePositions[before->Id()] : int(pageOrder.size());
+    int id = int(pages.size());
+    if(freePageIds.empty())
+    {
+        pages.push_back(nullptr);
+        pageVisible.push_back(1);
+        pageContexts.push_back(-1);
+        pagePositions.push_back(position);
+    }
+    else
+    {
+        id = freePageIds.back();
+        freePageIds.pop_back();
+        pageVisible[id] = 1;
+    }
+    Page* page = new Page(id, pageName);
+    pages[id] = page;
+    InsertPageOrder(id, position);
+    QObject::connect(page, &QObject::destroyed, this, [this, id]() { ReleasePage(id); });
+    page->context = context;
     QSignalBlocker blocker(page);
     QObject::connect(page, &Page::Hiding, this, &TabToolbar::HideTab);
     QObject::connect(page, &Page::Showing, this, &TabToolbar::ShowTab);
-    tabBar->addTab(page, pageName);
+    page->installEventFilter(this);
+    recentPages.append(page);
+    tabBar->insertTab(VisiblePagesBefore(id), page, pageName);
+    // tab inserted before current one shifts it without notification
+    currentIndex = tabBar->currentIndex();
+    return page;
+}
+
+Page* TabToolbar::InsertPage(Page* before, const QString& pageName, const QString& contextName)
+{
+    auto it = tabContextIndices.constFind(contextName);
+    if(it == tabContextIndices.constEnd())
+        throw std::logic_error(std::string("Unknown tab context: ") + contextName.toStdString());
+
+    Page* page = InsertPage(before, pageName);
+    const int id = page->Id();
+    TabContext& tabContext = tabContexts[it.value()];
+    pageContexts[id] = it.value();
+    tabContext.pages.append(id);
+    if(tabContext.active)
+        ApplyContextColor(id, VisiblePagesBefore(id));
+    else
+        ApplyPagesBatch([this, id]() { ApplyPageVisibility(id, false); });
     return page;
 }
 
@@ -305,3 +1129,20 @@ TabToolbar* tt::_FindTabToolbarParent(QWidget& startingWidget)
 
     return nullptr;
 }
+
+std::shared_ptr<ToolbarContext> tt::CreateDefaultToolbarContext()
+{
+    auto context = std::make_shared<ToolbarContext>();
+    context->scaleFactor = GetScaleFactor(*QGuiApplication::primaryScreen());
+    context->groupMaxHeight *= context->scaleFactor;
+    context->buttonStyle = TTToolButtonStyle::GetShared();
+    return context;
+}
+
+std::shared_ptr<ToolbarContext> tt::FindToolbarContext(QWidget* widget)
+{
+    for(QObject* obj = widget; obj; obj = obj->parent())
+        if(TabToolbar* tt = qobject_cast<TabToolbar*>(obj))
+            return tt->Context();
+    return CreateDefaultToolbarContext();
+}
@@ -15,12 +15,191 @@
     You should have received a copy of the GNU Lesser General Public License
     along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <QApplication>
+#include <QCache>
 #include <QPainter>
+#include <QStyleFactory>
 #include <QStyleOptionToolButton>
+#include <TabToolbar/StyleTools.h>
 #include "ToolButtonStyle.h"
 
 using namespace tt;
 
+namespace
+{
+struct IconKey
+{
+    qint64      cacheKey;
+    QSize       size;
+    qreal       devicePixelRatio;
+    QIcon::Mode mode;
+    QIcon::State state;
+
+    bool operator==(const IconKey& other) const
+    {
+        return cacheKey == other.cacheKey &&
+               size == other.size &&
+               devicePixelRatio == other.devicePixelRatio &&
+               mode == other.mode &&
+               state == other.state;
+    }
+};
+
+uint qHash(const IconKey& key, uint seed = 0)
+{
+    return ::qHash(key.cacheKey, seed) ^
+           ::qHash((key.size.width() << 16) ^ key.size.height()) ^
+           ::qHash(int(key.devicePixelRatio * 100.0)) ^
+           ::qHash((int(key.mode) << 1) | int(key.state));
+}
+
+//least recently used pixmaps are dropped first, cost is measured in bytes
+struct IconCache
+{
+    IconCache() : pixmaps(4 * 1024 * 1024) {}
+
+    QCache<IconKey, QPixmap> pixmaps;
+    IconCacheStats           stats;
+    bool                     cleanupRegistered = false;
+};
+
+IconCache& IconCacheInstance()
+{
+    static IconCache cache;
+    return cache;
+}
+
+//pixmaps must not outlive QApplication, while the cache itself is destroyed after it
+void ReleaseIconCache()
+{
+    IconCache& cache = IconCacheInstance();
+    cache.pixmaps.clear();
+    cache.cleanupRegistered = false;
+}
+
+IconCache& GetIconCache()
+{
+    IconCache& cache = IconCacheInstance();
+    if(!cache.cleanupRegistered && QCoreApplication::instance())
+    {
+        qAddPostRoutine(ReleaseIconCache);
+        cache.cleanupRegistered = true;
+    }
+    return cache;
+}
+
+QPixmap GetIconPixmap(const QIcon& icon, const QSize& size, QIcon::Mode mode, QIcon::State state)
+{
+    IconCache& cache = GetIconCache();
+    const IconKey key = {icon.cacheKey(), size, qApp->devicePixelRatio(), mode, state};
+    if(const QPixmap* pixmap = cache.pixmaps.object(key))
+    {
+        cache.stats.hits++;
+        return *pixmap;
+    }
+
+    cache.stats.misses++;
+    const QPixmap pixmap = icon.pixmap(size, mode, state);
+    const int cost = pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+    const int countBefore = cache.pixmaps.count();
+    if(cache.pixmaps.insert(key, new QPixmap(pixmap), cost))
+        cache.stats.evictions += countBefore + 1 - cache.pixmaps.count();
+    return pixmap;
+}
+}
+
+namespace tt
+{
+
+void SetIconCacheLimit(int bytes)
+{
+    IconCache& cache = GetIconCache();
+    const int countBefore = cache.pixmaps.count();
+    cache.pixmaps.setMaxCost(bytes);
+    cache.stats.evictions += countBefore - cache.pixmaps.count();
+}
+
+IconCacheStats GetIconCacheStats()
+{
+    const IconCache& cache = GetIconCache();
+    IconCacheStats stats = cache.stats;
+    stats.count = cache.pixmaps.count();
+    stats.bytes = cache.pixmaps.totalCost();
+    stats.limit = cache.pixmaps.maxCost();
+    return stats;
+}
+
+void ClearIconCache()
+{
+    IconCache& cache = GetIconCache();
+    cache.pixmaps.clear();
+    cache.stats = IconCacheStats();
+}
+
+}
+
+std::shared_ptr<TTToolButtonStyle> TTToolButtonStyle::GetShared()
+{
+    static std::weak_ptr<TTToolButtonStyle> shared;
+    std::shared_ptr<TTToolButtonStyle> style = shared.lock();
+    if(!style)
+    {
+        style = std::make_shared<TTToolButtonStyle>();
+        shared = style;
+    }
+    return style;
+}
+
+bool TTToolButtonStyle::UpdateBaseStyle()
+{
+    const QString appStyleName = QApplication::style()->objectName();
+    if(appStyleName.isEmpty() || baseStyle()->objectName().compare(appStyleName, Qt::CaseInsensitive) == 0)
+        return false;
+
+    QStyle* style = QStyleFactory::create(appStyleName);
+    if(!style)
+        return false;
+    setBaseStyle(style);
+    RepolishDependents();
+    return true;
+}
+
+void TTToolButtonStyle::AddDependent(QWidget* widget)
+{
+    if(dependents.contains(widget))
+        return;
+    dependents.insert(widget, QObject::connect(widget, &QObject::destroyed, this, [this, widget]()
+    {
+        dependents.remove(widget);
+    }));
+}
+
+void TTToolButtonStyle::polish(QWidget* widget)
+{
+    QProxyStyle::polish(widget);
+    AddDependent(widget);
+}
+
+void TTToolButtonStyle::unpolish(QWidget* widget)
+{
+    QObject::disconnect(dependents.take(widget));
+    QProxyStyle::unpolish(widget);
+}
+
+void TTToolButtonStyle::RepolishDependents()
+{
+    const QList<QWidget*> widgets = dependents.keys();
+    for(QWidget* widget : widgets)
+    {
+        if(widget->style() == this)
+            QProxyStyle::polish(widget);
+        QEvent event(QEvent::StyleChange);
+        QCoreApplication::sendEvent(widget, &event);
+        widget->updateGeometry();
+        widget->update();
+    }
+}
+
 //redefine text alignment
 void TTToolButtonStyle::drawControl(ControlElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const
 {
@@ -59,8 +238,8 @@ void TTToolButtonStyle::drawControl(ControlElement element, const QStyleOption*
                         mode = QIcon::Active;
                     else
                         mode = QIcon::Normal;
-                    pm = toolbutton->icon.pixmap(toolbutton->rect.size().boundedTo(toolbutton->iconSize),
-                                                 mode, state);
+                    pm = GetIconPixmap(toolbutton->icon, toolbutton->rect.size().boundedTo(toolbutton->iconSize),
+                                       mode, state);
                     pmSize = pm.size();
                 }
 
@@ -17,7 +17,9 @@
 */
 #ifndef TT_TOOL_BUTTON_STYLE
 #define TT_TOOL_BUTTON_STYLE
+#include <QHash>
 #include <QProxyStyle>
+#include <memory>
 
 class QStyleOptionToolButton;
 
@@ -28,8 +30,27 @@ namespace tt
 class TTToolButtonStyle : public QProxyStyle
 {
 public:
+    //single instance shared by all toolbars, destroyed along with the last one
+    static std::shared_ptr<TTToolButtonStyle> GetShared();
+
+    //recreates base style if application style has changed, returns true if it did;
+    //every widget styled by or depending on this instance is repolished then, whichever toolbar noticed the change
+    bool UpdateBaseStyle();
+    //widgets taking metrics from this style without using it, e.g. painted buttons
+    void AddDependent(QWidget* widget);
+
+    using QProxyStyle::polish;
+    using QProxyStyle::unpolish;
+    void polish(QWidget* widget) override;
+    void unpolish(QWidget* widget) override;
+
     void drawControl(ControlElement element, const QStyleOption* opt, QPainter* p, const QWidget* widget) const override;
     void drawComplexControl(ComplexControl cc, const QStyleOptionComplex* opt, QPainter* p, const QWidget* widget) const override;
+
+private:
+    void RepolishDependents();
+
+    QHash<QWidget*, QMetaObject::Connection> dependents; //to their destroyed connection
 };
 
 }
@@ -0,0 +1,800 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QDataStream>
+#include <QHash>
+#include <stdexcept>
+#include <cstring>
+#include <string>
+#include <TabToolbar/ToolbarConfig.h>
+
+using namespace tt;
+
+/*
+    Binary config layout, all numbers are little endian:
+
+    header:   char[4] "TTBC", quint16 version, quint16 flags (bit 0 - special tab, bit 1 - painted buttons),
+              qint32 groupHeight, qint32 groupRowCount
+    strings:  quint32 count, then each string as QDataStream serialized QString
+    tree:     corner actions, menus, contexts (since version 2) and tabs,
+              tab context name follows its display name (since version 2),
+              action icon follows its menu (since version 3)
+              string indices (quint32, 0xFFFFFFFF for none) and counts (quint32),
+              item types and popup modes are stored as quint8 enum values (see BinaryItemType, BinaryPopupMode),
+              subgroups hold neither subgroups nor separators, so items nest one level deep at most
+
+    Every string is stored once, no matter how many times config refers to it.
+*/
+
+namespace
+{
+const char     g_binaryMagic[4] = {'T', 'T', 'B', 'C'};
+const quint16  g_binaryVersion = 3;
+const quint32  g_noString = 0xFFFFFFFF;
+const int      g_headerSize = 16;
+
+//stored popup mode values, independent of QToolButton::ToolButtonPopupMode
+enum class BinaryPopupMode : quint8
+{
+    Delayed    = 0,
+    MenuButton = 1,
+    Instant    = 2
+};
+
+quint8 ToBinary(QToolButton::ToolButtonPopupMode type)
+{
+    switch(type)
+    {
+        case QToolButton::DelayedPopup:
+            return quint8(BinaryPopupMode::Delayed);
+        case QToolButton::MenuButtonPopup:
+            return quint8(BinaryPopupMode::MenuButton);
+        case QToolButton::InstantPopup:
+            return quint8(BinaryPopupMode::Instant);
+    }
+    throw std::logic_error("Unknown toolbutton popup mode!");
+}
+
+QToolButton::ToolButtonPopupMode PopupModeFromBinary(quint8 type)
+{
+    switch(static_cast<BinaryPopupMode>(type))
+    {
+        case BinaryPopupMode::Delayed:
+            return QToolButton::DelayedPopup;
+        case BinaryPopupMode::MenuButton:
+            return QToolButton::MenuButtonPopup;
+        case BinaryPopupMode::Instant:
+            return QToolButton::InstantPopup;
+    }
+    throw std::runtime_error("Binary TabToolbar config is corrupted!");
+}
+
+//stored item type values, independent of ItemConfig::Type
+enum class BinaryItemType : quint8
+{
+    Action            = 0,
+    SubGroup          = 1,
+    Separator         = 2,
+    HorizontalActions = 3,
+    Custom            = 4
+};
+
+quint8 ToBinary(ItemConfig::Type type)
+{
+    switch(type)
+    {
+        case ItemConfig::Type::Action:
+            return quint8(BinaryItemType::Action);
+        case ItemConfig::Type::SubGroup:
+            return quint8(BinaryItemType::SubGroup);
+        case ItemConfig::Type::Separator:
+            return quint8(BinaryItemType::Separator);
+        case ItemConfig::Type::HorizontalActions:
+            return quint8(BinaryItemType::HorizontalActions);
+        case ItemConfig::Type::Custom:
+            return quint8(BinaryItemType::Custom);
+    }
+    throw std::logic_error("Unknown item type!");
+}
+
+ItemConfig::Type ItemTypeFromBinary(quint8 type)
+{
+    switch(static_cast<BinaryItemType>(type))
+    {
+        case BinaryItemType::Action:
+            return ItemConfig::Type::Action;
+        case BinaryItemType::SubGroup:
+            return ItemConfig::Type::SubGroup;
+        case BinaryItemType::Separator:
+            return ItemConfig::Type::Separator;
+        case BinaryItemType::HorizontalActions:
+            return ItemConfig::Type::HorizontalActions;
+        case BinaryItemType::Custom:
+            return ItemConfig::Type::Custom;
+    }
+    throw std::runtime_error("Binary TabToolbar config is corrupted!");
+}
+
+bool IsAllowedInSubGroup(ItemConfig::Type type)
+{
+    return type != ItemConfig::Type::SubGroup && type != ItemConfig::Type::Separator;
+}
+
+QToolButton::ToolButtonPopupMode ParsePopupMode(const QString& type)
+{
+    if(type == "delayedPopup")
+        return QToolButton::DelayedPopup;
+    else if(type == "instantPopup")
+        return QToolButton::InstantPopup;
+    else if(type == "menuButtonPopup")
+        return QToolButton::MenuButtonPopup;
+    throw std::logic_error(std::string("Unknown toolbutton popup mode: ") + type.toStdString());
+}
+
+QString PopupModeName(QToolButton::ToolButtonPopupMode type)
+{
+    switch(type)
+    {
+        case QToolButton::DelayedPopup:
+            return "delayedPopup";
+        case QToolButton::InstantPopup:
+            return "instantPopup";
+        case QToolButton::MenuButtonPopup:
+            return "menuButtonPopup";
+    }
+    throw std::logic_error("Unknown toolbutton popup mode!");
+}
+
+ActionConfig ParseAction(const QJsonObject& obj)
+{
+    ActionConfig action;
+    action.type = ParsePopupMode(obj["type"].toString());
+    action.name = obj["name"].toString();
+    if(obj.contains("menu") && !obj["menu"].isNull())
+        action.menu = obj["menu"].toString();
+    action.icon = obj["icon"].toString();
+    return action;
+}
+
+ItemConfig ParseCustomItem(const QString& type, const QJsonObject& obj)
+{
+    ItemConfig item;
+    item.type = ItemConfig::Type::Custom;
+    item.customType = type;
+    item.name = obj["name"].toString();
+    item.properties = obj;
+    return item;
+}
+
+ItemConfig ParseSubGroupItem(const QJsonObject& obj)
+{
+    const QString itemType = obj["itemType"].toString();
+    ItemConfig item;
+    if(itemType == "action")
+    {
+        item.type = ItemConfig::Type::Action;
+        item.action = ParseAction(obj);
+    }
+    else if(itemType == "horizontalActions")
+    {
+        item.type = ItemConfig::Type::HorizontalActions;
+        const QJsonArray actions = obj["actions"].toArray();
+        for(int i=0; i<actions.size(); i++)
+            item.actions.append(ParseAction(actions.at(i).toObject()));
+    }
+    else
+    {
+        item = ParseCustomItem(itemType, obj);
+    }
+    return item;
+}
+
+ItemConfig ParseItem(const QJsonObject& obj)
+{
+    const QString itemType = obj["itemType"].toString();
+    ItemConfig item;
+    if(itemType == "action")
+    {
+        item.type = ItemConfig::Type::Action;
+        item.action = ParseAction(obj);
+    }
+    else if(itemType == "subgroup")
+    {
+        item.type = ItemConfig::Type::SubGroup;
+        item.name = obj["name"].toString();
+        item.aligned = obj["aligned"].toBool();
+        const QJsonArray content = obj["content"].toArray();
+        for(int i=0; i<content.size(); i++)
+            item.content.append(ParseSubGroupItem(content.at(i).toObject()));
+    }
+    else if(itemType == "separator")
+    {
+        item.type = ItemConfig::Type::Separator;
+    }
+    else
+    {
+        item = ParseCustomItem(itemType, obj);
+    }
+    return item;
+}
+
+QJsonObject ActionToJson(const ActionConfig& action)
+{
+    QJsonObject obj;
+    obj["type"] = PopupModeName(action.type);
+    obj["name"] = action.name;
+    if(!action.menu.isEmpty())
+        obj["menu"] = action.menu;
+    if(!action.icon.isEmpty())
+        obj["icon"] = action.icon;
+    return obj;
+}
+
+QJsonObject ItemToJson(const ItemConfig& item)
+{
+    QJsonObject obj;
+    switch(item.type)
+    {
+        case ItemConfig::Type::Action:
+            obj = ActionToJson(item.action);
+            obj["itemType"] = QString("action");
+            break;
+        case ItemConfig::Type::SubGroup:
+        {
+            QJsonArray content;
+            for(const ItemConfig& sgItem : item.content)
+                content.append(ItemToJson(sgItem));
+            obj["itemType"] = QString("subgroup");
+            obj["name"] = item.name;
+            obj["aligned"] = item.aligned;
+            obj["content"] = content;
+            break;
+        }
+        case ItemConfig::Type::Separator:
+            obj["itemType"] = QString("separator");
+            break;
+        case ItemConfig::Type::HorizontalActions:
+        {
+            QJsonArray actions;
+            for(const ActionConfig& action : item.actions)
+                actions.append(ActionToJson(action));
+            obj["itemType"] = QString("horizontalActions");
+            obj["actions"] = actions;
+            break;
+        }
+        case ItemConfig::Type::Custom:
+            obj = item.properties;
+            obj["itemType"] = item.customType;
+            if(!item.name.isEmpty())
+                obj["name"] = item.name;
+            break;
+    }
+    return obj;
+}
+
+class BinaryWriter
+{
+public:
+    QByteArray Write(const ToolbarConfig& config)
+    {
+        QByteArray tree;
+        {
+            QDataStream out(&tree, QIODevice::WriteOnly);
+            Prepare(out);
+            WriteStrings(out, config.cornerActions);
+            Count(out, config.menus.size());
+            for(const MenuConfig& menu : config.menus)
+            {
+                String(out, menu.name);
+                WriteStrings(out, menu.actions);
+            }
+            Count(out, config.contexts.size());
+            for(const ContextConfig& contextConfig : config.contexts)
+            {
+                String(out, contextConfig.name);
+                String(out, contextConfig.color);
+            }
+            Count(out, config.tabs.size());
+            for(const TabConfig& tab : config.tabs)
+            {
+                String(out, tab.name);
+                String(out, tab.displayName);
+                String(out, tab.context);
+                Count(out, tab.groups.size());
+                for(const GroupConfig& group : tab.groups)
+                {
+                    String(out, group.name);
+                    String(out, group.displayName);
+                    WriteItems(out, group.content);
+                }
+            }
+        }
+
+        QByteArray result;
+        QDataStream out(&result, QIODevice::WriteOnly);
+        Prepare(out);
+        out.writeRawData(g_binaryMagic, sizeof(g_binaryMagic));
+        out << g_binaryVersion
+            << quint16((config.specialTab ? 1 : 0) | (config.paintedButtons ? 2 : 0))
+            << qint32(config.groupHeight)
+            << qint32(config.groupRowCount);
+        Count(out, strings.size());
+        for(const QString& str : strings)
+            out << str;
+        out.writeRawData(tree.constData(), tree.size());
+        return result;
+    }
+
+private:
+    static void Prepare(QDataStream& stream)
+    {
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream.setByteOrder(QDataStream::LittleEndian);
+    }
+
+    static void Count(QDataStream& out, int count)
+    {
+        out << quint32(count);
+    }
+
+    void String(QDataStream& out, const QString& str)
+    {
+        if(str.isNull())
+        {
+            out << g_noString;
+            return;
+        }
+        auto it = stringIndices.constFind(str);
+        if(it == stringIndices.constEnd())
+        {
+            it = stringIndices.insert(str, quint32(strings.size()));
+            strings.append(str);
+        }
+        out << it.value();
+    }
+
+    void WriteStrings(QDataStream& out, const QStringList& list)
+    {
+        Count(out, list.size());
+        for(const QString& str : list)
+            String(out, str);
+    }
+
+    void WriteAction(QDataStream& out, const ActionConfig& action)
+    {
+        out << ToBinary(action.type);
+        String(out, action.name);
+        String(out, action.menu.isEmpty() ? QString() : action.menu);
+        String(out, action.icon.isEmpty() ? QString() : action.icon);
+    }
+
+    void WriteItems(QDataStream& out, const QVector<ItemConfig>& items, bool inSubGroup = false)
+    {
+        Count(out, items.size());
+        for(const ItemConfig& item : items)
+        {
+            //reader would reject it, see IsAllowedInSubGroup
+            if(inSubGroup && !IsAllowedInSubGroup(item.type))
+                throw std::logic_error("SubGroup can not contain subgroups or separators!");
+            out << ToBinary(item.type);
+            switch(item.type)
+            {
+                case ItemConfig::Type::Action:
+                    WriteAction(out, item.action);
+                    break;
+                case ItemConfig::Type::SubGroup:
+                    String(out, item.name);
+                    out << quint8(item.aligned ? 1 : 0);
+                    WriteItems(out, item.content, true);
+                    break;
+                case ItemConfig::Type::Separator:
+                    break;
+                case ItemConfig::Type::HorizontalActions:
+                    Count(out, item.actions.size());
+                    for(const ActionConfig& action : item.actions)
+                        WriteAction(out, action);
+                    break;
+                case ItemConfig::Type::Custom:
+                    String(out, item.customType);
+                    String(out, item.name);
+                    String(out, QString::fromUtf8(QJsonDocument(item.properties).toJson(QJsonDocument::Compact)));
+                    break;
+            }
+        }
+    }
+
+    QHash<QString, quint32> stringIndices;
+    QStringList             strings;
+};
+
+class BinaryReader
+{
+public:
+    BinaryReader(const uchar* data, qint64 size) :
+        buffer(QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(size))),
+        in(buffer)
+    {
+        in.setVersion(QDataStream::Qt_5_0);
+        in.setByteOrder(QDataStream::LittleEndian);
+    }
+
+    ToolbarConfig Read()
+    {
+        if(!IsBinaryConfig(reinterpret_cast<const uchar*>(buffer.constData()), buffer.size()))
+            throw std::runtime_error("Not a binary TabToolbar config!");
+        in.skipRawData(sizeof(g_binaryMagic));
+
+        quint16 flags = 0;
+        qint32 groupHeight = 0;
+        qint32 groupRowCount = 0;
+        in >> version >> flags >> groupHeight >> groupRowCount;
+        if(version == 0 || version > g_binaryVersion)
+            throw std::runtime_error("Unsupported binary TabToolbar config version: " + std::to_string(version));
+
+        ToolbarConfig config;
+        config.specialTab = (flags & 1) != 0;
+        config.paintedButtons = (flags & 2) != 0;
+        config.groupHeight = groupHeight;
+        config.groupRowCount = groupRowCount;
+
+        const quint32 stringCount = Count();
+        strings.reserve(int(stringCount));
+        for(quint32 i=0; i<stringCount; i++)
+        {
+            QString str;
+            in >> str;
+            strings.append(str);
+        }
+        Check();
+
+        config.cornerActions = ReadStrings();
+        const quint32 menuCount = Count();
+        for(quint32 i=0; i<menuCount; i++)
+        {
+            MenuConfig menu;
+            menu.name = String();
+            menu.actions = ReadStrings();
+            config.menus.append(menu);
+        }
+        if(version >= 2)
+        {
+            const quint32 contextCount = Count();
+            for(quint32 i=0; i<contextCount; i++)
+            {
+                ContextConfig contextConfig;
+                contextConfig.name = String();
+                contextConfig.color = String();
+                config.contexts.append(contextConfig);
+            }
+        }
+        const quint32 tabCount = Count();
+        for(quint32 i=0; i<tabCount; i++)
+        {
+            TabConfig tab;
+            tab.name = String();
+            tab.displayName = String();
+            if(version >= 2)
+                tab.context = String();
+            const quint32 groupCount = Count();
+            for(quint32 j=0; j<groupCount; j++)
+            {
+                GroupConfig group;
+                group.name = String();
+                group.displayName = String();
+                group.content = ReadItems();
+                tab.groups.append(group);
+            }
+            config.tabs.append(tab);
+        }
+        Check();
+        return config;
+    }
+
+private:
+    void Check() const
+    {
+        if(in.status() != QDataStream::Ok)
+            throw std::runtime_error("Binary TabToolbar config is corrupted!");
+    }
+
+    quint32 Count()
+    {
+        quint32 count = 0;
+        in >> count;
+        Check();
+        if(count > quint32(buffer.size()))
+            throw std::runtime_error("Binary TabToolbar config is corrupted!");
+        return count;
+    }
+
+    QString String()
+    {
+        quint32 index = g_noString;
+        in >> index;
+        Check();
+        if(index == g_noString)
+            return QString();
+        if(index >= quint32(strings.size()))
+            throw std::runtime_error("Binary TabToolbar config is corrupted!");
+        return strings.at(int(index));
+    }
+
+    QStringList ReadStrings()
+    {
+        QStringList list;
+        const quint32 count = Count();
+        for(quint32 i=0; i<count; i++)
+            list.append(String());
+        return list;
+    }
+
+    ActionConfig ReadAction()
+    {
+        quint8 type = 0;
+        in >> type;
+        Check();
+        ActionConfig action;
+        action.type = PopupModeFromBinary(type);
+        action.name = String();
+        action.menu = String();
+        if(version >= 3)
+            action.icon = String();
+        return action;
+    }
+
+    //nesting is limited the way json schema limits it, so that a crafted file can not exhaust the stack
+    QVector<ItemConfig> ReadItems(bool inSubGroup = false)
+    {
+        QVector<ItemConfig> items;
+        const quint32 count = Count();
+        items.reserve(int(count));
+        for(quint32 i=0; i<count; i++)
+        {
+            quint8 type = 0;
+            in >> type;
+            Check();
+
+            ItemConfig item;
+            item.type = ItemTypeFromBinary(type);
+            if(inSubGroup && !IsAllowedInSubGroup(item.type))
+                throw std::runtime_error("Binary TabToolbar config is corrupted!");
+            switch(item.type)
+            {
+                case ItemConfig::Type::Action:
+                    item.action = ReadAction();
+                    break;
+                case ItemConfig::Type::SubGroup:
+                {
+                    quint8 aligned = 0;
+                    item.name = String();
+                    in >> aligned;
+                    item.aligned = (aligned != 0);
+                    item.content = ReadItems(true);
+                    break;
+                }
+                case ItemConfig::Type::Separator:
+                    break;
+                case ItemConfig::Type::HorizontalActions:
+                {
+                    const quint32 actionCount = Count();
+                    for(quint32 j=0; j<actionCount; j++)
+                        item.actions.append(ReadAction());
+                    break;
+                }
+                case ItemConfig::Type::Custom:
+                    item.customType = String();
+                    item.name = String();
+                    item.properties = QJsonDocument::fromJson(String().toUtf8()).object();
+                    break;
+            }
+            items.append(item);
+        }
+        return items;
+    }
+
+    const QByteArray buffer;
+    QDataStream      in;
+    QStringList      strings;
+    quint16          version = 0;
+};
+
+void CollectActionIcons(const QVector<ItemConfig>& items, QMap<QString, QString>& icons)
+{
+    for(const ItemConfig& item : items)
+    {
+        if(item.type == ItemConfig::Type::Action && !item.action.icon.isEmpty())
+            icons.insert(item.action.name, item.action.icon);
+        for(const ActionConfig& action : item.actions)
+            if(!action.icon.isEmpty())
+                icons.insert(action.name, action.icon);
+        CollectActionIcons(item.content, icons);
+    }
+}
+}
+
+bool tt::operator==(const ActionConfig& left, const ActionConfig& right)
+{
+    return left.type == right.type && left.name == right.name &&
+           left.menu == right.menu && left.icon == right.icon;
+}
+
+bool tt::operator==(const ItemConfig& left, const ItemConfig& right)
+{
+    return left.type == right.type && left.name == right.name && left.customType == right.customType &&
+           left.properties == right.properties && left.aligned == right.aligned && left.action == right.action &&
+           left.actions == right.actions && left.content == right.content;
+}
+
+bool tt::operator==(const GroupConfig& left, const GroupConfig& right)
+{
+    return left.name == right.name && left.displayName == right.displayName && left.content == right.content;
+}
+
+bool tt::operator==(const TabConfig& left, const TabConfig& right)
+{
+    return left.name == right.name && left.displayName == right.displayName &&
+           left.context == right.context && left.groups == right.groups;
+}
+
+ToolbarConfig tt::ParseConfig(const QJsonObject& root)
+{
+    ToolbarConfig config;
+    config.groupHeight = root["groupHeight"].toInt();
+    config.groupRowCount = root["groupRowCount"].toInt();
+    config.specialTab = root["specialTab"].toBool();
+    config.paintedButtons = root["paintedButtons"].toBool();
+
+    const QJsonArray cornerActions = root["cornerActions"].toArray();
+    for(int i=0; i<cornerActions.size(); i++)
+        config.cornerActions.append(cornerActions.at(i).toString());
+
+    const QJsonArray menusList = root["menus"].toArray();
+    for(int i=0; i<menusList.size(); i++)
+    {
+        const QJsonObject menuObject = menusList.at(i).toObject();
+        MenuConfig menu;
+        menu.name = menuObject["name"].toString();
+        const QJsonArray menuActions = menuObject["actions"].toArray();
+        for(int j=0; j<menuActions.size(); j++)
+            menu.actions.append(menuActions.at(j).toString());
+        config.menus.append(menu);
+    }
+
+    const QJsonArray contextsList = root["contexts"].toArray();
+    for(int i=0; i<contextsList.size(); i++)
+    {
+        const QJsonObject contextObject = contextsList.at(i).toObject();
+        ContextConfig contextConfig;
+        contextConfig.name = contextObject["name"].toString();
+        contextConfig.color = contextObject["color"].toString();
+        config.contexts.append(contextConfig);
+    }
+
+    const QJsonArray tabs = root["tabs"].toArray();
+    for(int i=0; i<tabs.size(); i++)
+    {
+        const QJsonObject tabObject = tabs.at(i).toObject();
+        TabConfig tab;
+        tab.name = tabObject["name"].toString();
+        tab.displayName = tabObject["displayName"].toString();
+        tab.context = tabObject["context"].toString();
+        const QJsonArray groups = tabObject["groups"].toArray();
+        for(int j=0; j<groups.size(); j++)
+        {
+            const QJsonObject groupObject = groups.at(j).toObject();
+            GroupConfig group;
+            group.name = groupObject["name"].toString();
+            group.displayName = groupObject["displayName"].toString();
+            const QJsonArray content = groupObject["content"].toArray();
+            for(int k=0; k<content.size(); k++)
+                group.content.append(ParseItem(content.at(k).toObject()));
+            tab.groups.append(group);
+        }
+        config.tabs.append(tab);
+    }
+    return config;
+}
+
+QJsonObject tt::ConfigToJson(const ToolbarConfig& config)
+{
+    QJsonObject root;
+    root["groupHeight"] = config.groupHeight;
+    root["groupRowCount"] = config.groupRowCount;
+    root["specialTab"] = config.specialTab;
+    if(config.paintedButtons)
+        root["paintedButtons"] = true;
+    root["cornerActions"] = QJsonArray::fromStringList(config.cornerActions);
+
+    QJsonArray menus;
+    for(const MenuConfig& menu : config.menus)
+    {
+        QJsonObject menuObject;
+        menuObject["name"] = menu.name;
+        menuObject["actions"] = QJsonArray::fromStringList(menu.actions);
+        menus.append(menuObject);
+    }
+    root["menus"] = menus;
+
+    if(!config.contexts.isEmpty())
+    {
+        QJsonArray contexts;
+        for(const ContextConfig& contextConfig : config.contexts)
+        {
+            QJsonObject contextObject;
+            contextObject["name"] = contextConfig.name;
+            if(!contextConfig.color.isEmpty())
+                contextObject["color"] = contextConfig.color;
+            contexts.append(contextObject);
+        }
+        root["contexts"] = contexts;
+    }
+
+    QJsonArray tabs;
+    for(const TabConfig& tab : config.tabs)
+    {
+        QJsonArray groups;
+        for(const GroupConfig& group : tab.groups)
+        {
+            QJsonArray content;
+            for(const ItemConfig& item : group.content)
+                content.append(ItemToJson(item));
+            QJsonObject groupObject;
+            groupObject["displayName"] = group.displayName;
+            groupObject["name"] = group.name;
+            groupObject["content"] = content;
+            groups.append(groupObject);
+        }
+        QJsonObject tabObject;
+        tabObject["displayName"] = tab.displayName;
+        tabObject["name"] = tab.name;
+        if(!tab.context.isEmpty())
+            tabObject["context"] = tab.context;
+        tabObject["groups"] = groups;
+        tabs.append(tabObject);
+    }
+    root["tabs"] = tabs;
+    return root;
+}
+
+QMap<QString, QString> tt::CollectActionIcons(const ToolbarConfig& config)
+{
+    QMap<QString, QString> icons;
+    for(const TabConfig& tab : config.tabs)
+        for(const GroupConfig& group : tab.groups)
+            ::CollectActionIcons(group.content, icons);
+    return icons;
+}
+
+QByteArray tt::ConfigToBinary(const ToolbarConfig& config)
+{
+    BinaryWriter writer;
+    return writer.Write(config);
+}
+
+bool tt::IsBinaryConfig(const uchar* data, qint64 size)
+{
+    return data && size >= g_headerSize && std::memcmp(data, g_binaryMagic, sizeof(g_binaryMagic)) == 0;
+}
+
+ToolbarConfig tt::ParseBinaryConfig(const uchar* data, qint64 size)
+{
+    BinaryReader reader(data, size);
+    return reader.Read();
+}
@@ -0,0 +1,229 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QSet>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <TabToolbar/ToolbarModel.h>
+
+using namespace tt;
+
+namespace
+{
+void CheckIndex(int index, int size, const char* what)
+{
+    if(index < 0 || index >= size)
+        throw std::out_of_range(std::string(what) + " index is out of range!");
+}
+
+template<class T>
+int IndexOfName(const QVector<T>& list, const QString& name, int from)
+{
+    for(int i=from; i<list.size(); i++)
+        if(list.at(i).name == name)
+            return i;
+    return -1;
+}
+
+template<class T>
+QSet<QString> Names(const QVector<T>& list)
+{
+    QSet<QString> names;
+    for(const T& entry : list)
+        names.insert(entry.name);
+    return names;
+}
+}
+
+ToolbarModel::ToolbarModel(QObject* parent) :
+    QObject(parent)
+{
+}
+
+ToolbarModel::ToolbarModel(const ToolbarConfig& _config, QObject* parent) :
+    QObject(parent),
+    config(_config)
+{
+}
+
+const ToolbarConfig& ToolbarModel::Config() const
+{
+    return config;
+}
+
+void ToolbarModel::Reset(const ToolbarConfig& newConfig)
+{
+    config = newConfig;
+    emit ModelReset();
+}
+
+void ToolbarModel::Update(const ToolbarConfig& newConfig)
+{
+    // heights and corner actions are picked up by views created afterwards
+    QVector<TabConfig> tabs = config.tabs;
+    config = newConfig;
+    config.tabs = tabs;
+    emit SettingsChanged();
+
+    const QSet<QString> names = Names(newConfig.tabs);
+    for(int i=config.tabs.size()-1; i>=0; i--)
+        if(!names.contains(config.tabs.at(i).name))
+            RemoveTab(i);
+
+    for(int i=0; i<newConfig.tabs.size(); i++)
+    {
+        const TabConfig& tab = newConfig.tabs.at(i);
+        const int existing = IndexOfName(config.tabs, tab.name, i);
+        if(existing == i)
+        {
+            const TabConfig& current = config.tabs.at(i);
+            if(current.displayName == tab.displayName && current.context == tab.context)
+            {
+                if(current.groups != tab.groups)
+                    UpdateGroups(i, tab.groups);
+                continue;
+            }
+        }
+        // moved tab or changed tab header
+        if(existing >= 0)
+            RemoveTab(existing);
+        InsertTab(i, tab);
+    }
+
+    while(config.tabs.size() > newConfig.tabs.size())
+        RemoveTab(config.tabs.size() - 1);
+}
+
+void ToolbarModel::UpdateGroups(int tabIndex, const QVector<GroupConfig>& groups)
+{
+    const QSet<QString> names = Names(groups);
+    for(int i=config.tabs.at(tabIndex).groups.size()-1; i>=0; i--)
+        if(!names.contains(config.tabs.at(tabIndex).groups.at(i).name))
+            RemoveGroup(tabIndex, i);
+
+    for(int i=0; i<groups.size(); i++)
+    {
+        const GroupConfig& group = groups.at(i);
+        const int existing = IndexOfName(config.tabs.at(tabIndex).groups, group.name, i);
+        if(existing == i && config.tabs.at(tabIndex).groups.at(i).displayName == group.displayName)
+        {
+            if(config.tabs.at(tabIndex).groups.at(i).content != group.content)
+                UpdateItems(tabIndex, i, group.content);
+            continue;
+        }
+        if(existing >= 0)
+            RemoveGroup(tabIndex, existing);
+        InsertGroup(tabIndex, i, group);
+    }
+
+    while(config.tabs.at(tabIndex).groups.size() > groups.size())
+        RemoveGroup(tabIndex, config.tabs.at(tabIndex).groups.size() - 1);
+}
+
+void ToolbarModel::UpdateItems(int tabIndex, int groupIndex, const QVector<ItemConfig>& items)
+{
+    // items have no identity, so only the range between equal head and tail is touched
+    const QVector<ItemConfig>& current = config.tabs.at(tabIndex).groups.at(groupIndex).content;
+    const int oldSize = current.size();
+    const int newSize = items.size();
+    int head = 0;
+    while(head < oldSize && head < newSize && current.at(head) == items.at(head))
+        head++;
+    int tail = 0;
+    while(tail < oldSize - head && tail < newSize - head &&
+          current.at(oldSize - 1 - tail) == items.at(newSize - 1 - tail))
+        tail++;
+
+    const int oldMiddle = oldSize - head - tail;
+    const int newMiddle = newSize - head - tail;
+    const int common = std::min(oldMiddle, newMiddle);
+    for(int i=0; i<common; i++)
+        if(config.tabs.at(tabIndex).groups.at(groupIndex).content.at(head + i) != items.at(head + i))
+            SetItem(tabIndex, groupIndex, head + i, items.at(head + i));
+    for(int i=common; i<oldMiddle; i++)
+        RemoveItem(tabIndex, groupIndex, head + common);
+    for(int i=common; i<newMiddle; i++)
+        InsertItem(tabIndex, groupIndex, head + i, items.at(head + i));
+}
+
+TabConfig& ToolbarModel::TabAt(int tabIndex)
+{
+    CheckIndex(tabIndex, config.tabs.size(), "Tab");
+    return config.tabs[tabIndex];
+}
+
+GroupConfig& ToolbarModel::GroupAt(int tabIndex, int groupIndex)
+{
+    TabConfig& tab = TabAt(tabIndex);
+    CheckIndex(groupIndex, tab.groups.size(), "Group");
+    return tab.groups[groupIndex];
+}
+
+void ToolbarModel::InsertTab(int tabIndex, const TabConfig& tab)
+{
+    CheckIndex(tabIndex, config.tabs.size() + 1, "Tab");
+    config.tabs.insert(tabIndex, tab);
+    emit TabInserted(tabIndex);
+}
+
+void ToolbarModel::RemoveTab(int tabIndex)
+{
+    CheckIndex(tabIndex, config.tabs.size(), "Tab");
+    config.tabs.remove(tabIndex);
+    emit TabRemoved(tabIndex);
+}
+
+void ToolbarModel::InsertGroup(int tabIndex, int groupIndex, const GroupConfig& group)
+{
+    TabConfig& tab = TabAt(tabIndex);
+    CheckIndex(groupIndex, tab.groups.size() + 1, "Group");
+    tab.groups.insert(groupIndex, group);
+    emit GroupInserted(tabIndex, groupIndex);
+}
+
+void ToolbarModel::RemoveGroup(int tabIndex, int groupIndex)
+{
+    TabConfig& tab = TabAt(tabIndex);
+    CheckIndex(groupIndex, tab.groups.size(), "Group");
+    tab.groups.remove(groupIndex);
+    emit GroupRemoved(tabIndex, groupIndex);
+}
+
+void ToolbarModel::InsertItem(int tabIndex, int groupIndex, int itemIndex, const ItemConfig& item)
+{
+    GroupConfig& group = GroupAt(tabIndex, groupIndex);
+    CheckIndex(itemIndex, group.content.size() + 1, "Item");
+    group.content.insert(itemIndex, item);
+    emit ItemInserted(tabIndex, groupIndex, itemIndex);
+}
+
+void ToolbarModel::RemoveItem(int tabIndex, int groupIndex, int itemIndex)
+{
+    GroupConfig& group = GroupAt(tabIndex, groupIndex);
+    CheckIndex(itemIndex, group.content.size(), "Item");
+    group.content.remove(itemIndex);
+    emit ItemRemoved(tabIndex, groupIndex, itemIndex);
+}
+
+void ToolbarModel::SetItem(int tabIndex, int groupIndex, int itemIndex, const ItemConfig& item)
+{
+    GroupConfig& group = GroupAt(tabIndex, groupIndex);
+    CheckIndex(itemIndex, group.content.size(), "Item");
+    group.content[itemIndex] = item;
+    emit ItemChanged(tabIndex, groupIndex, itemIndex);
+}
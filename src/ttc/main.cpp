@@ -0,0 +1,522 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QJsonParseError>
+#include <QRegExp>
+#include <QSet>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+#include <stdexcept>
+#include <cstdio>
+#include <TabToolbar/ToolbarConfig.h>
+
+//ttc - compiles TabToolbar json config into C++ header, the same way uic does with .ui files.
+//Generated class calls TabToolbar/Page/Group/SubGroup API directly, actions are taken
+//from user supplied object (usually Ui::MainWindow) by member name, so any typo
+//in config becomes compile error instead of runtime one.
+//With --binary it converts json config to binary one (and back with --json),
+//which Builder loads without json parsing.
+
+namespace
+{
+class ConfigError : public std::runtime_error
+{
+public:
+    explicit ConfigError(const QString& what) : std::runtime_error(what.toStdString()) {}
+};
+
+class Generator
+{
+public:
+    explicit Generator(const QString& name) : className(name)
+    {
+        usedIdentifiers << "tabToolbar" << "setupTabToolbar" << "createCustom"
+                        << "TCustomWidgetCreator" << "parent" << "actions" << "createCustomWidget";
+    }
+
+    void Generate(const tt::ToolbarConfig& config)
+    {
+        Line(QString("tabToolbar = new tt::TabToolbar(parent, %1, %2);")
+             .arg(config.groupHeight)
+             .arg(config.groupRowCount));
+        if(config.paintedButtons)
+            Line("tabToolbar->SetPaintedButtons(true);");
+
+        const QMap<QString, QString> actionIcons = tt::CollectActionIcons(config);
+        for(auto it = actionIcons.constBegin(); it != actionIcons.constEnd(); ++it)
+            Line("if(" + ActionRef(it.key()) + "->icon().isNull()) " + ActionRef(it.key()) +
+                 "->setIcon(QIcon(" + Literal(it.value()) + "));");
+
+        for(const QString& actionName : config.cornerActions)
+            Line("tabToolbar->AddCornerAction(" + ActionRef(actionName) + ");");
+
+        for(const tt::MenuConfig& menuConfig : config.menus)
+        {
+            const QString menu = Member("QMenu*", menuConfig.name);
+            configMenus[menuConfig.name] = menu;
+            Line(menu + " = new QMenu(parent);");
+            Line(menu + "->setObjectName(" + Literal(menuConfig.name) + ");");
+            for(const QString& actionName : menuConfig.actions)
+            {
+                if(actionName == "separator")
+                    Line(menu + "->addSeparator();");
+                else
+                    Line(menu + "->addAction(" + ActionRef(actionName) + ");");
+            }
+        }
+
+        QSet<QString> contexts;
+        for(const tt::ContextConfig& contextConfig : config.contexts)
+        {
+            contexts.insert(contextConfig.name);
+            if(contextConfig.color.isEmpty())
+                Line("tabToolbar->AddContext(" + Literal(contextConfig.name) + ");");
+            else
+                Line("tabToolbar->AddContext(" + Literal(contextConfig.name) +
+                     ", QColor(" + Literal(contextConfig.color) + "));");
+        }
+
+        for(const tt::TabConfig& tab : config.tabs)
+        {
+            const QString page = Assign("tt::Page*", tab.name, "page");
+            if(tab.context.isEmpty())
+                Line(page + " = tabToolbar->AddPage(" + Literal(tab.displayName) + ");");
+            else if(contexts.contains(tab.context))
+                Line(page + " = tabToolbar->AddPage(" + Literal(tab.displayName) + ", " + Literal(tab.context) + ");");
+            else
+                throw ConfigError(QString("tab \"%1\" refers to unknown context \"%2\"").arg(tab.name).arg(tab.context));
+            for(const tt::GroupConfig& group : tab.groups)
+                GenerateGroup(Name(page), group);
+        }
+
+        Line(QString("tabToolbar->SetSpecialTabEnabled(%1);").arg(config.specialTab ? "true" : "false"));
+    }
+
+    void Write(QTextStream& out, const QString& configName) const
+    {
+        const QString guard = "TT_" + className.toUpper() + "_H";
+        out << "/********************************************************************************\n"
+            << "** TabToolbar generated from reading config file '" << configName << "'\n"
+            << "**\n"
+            << "** WARNING! All changes made in this file will be lost when recompiling config file!\n"
+            << "********************************************************************************/\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n"
+            << "#include <QIcon>\n"
+            << "#include <QJsonArray>\n"
+            << "#include <QJsonObject>\n"
+            << "#include <QJsonValue>\n"
+            << "#include <QMenu>\n"
+            << "#include <QString>\n"
+            << "#include <QToolButton>\n"
+            << "#include <QWidget>\n"
+            << "#include <functional>\n"
+            << "#include <stdexcept>\n"
+            << "#include <string>\n"
+            << "#include <vector>\n"
+            << "#include <TabToolbar/TabToolbar.h>\n"
+            << "#include <TabToolbar/Page.h>\n"
+            << "#include <TabToolbar/Group.h>\n"
+            << "#include <TabToolbar/SubGroup.h>\n"
+            << "\n"
+            << "class TT_" << className << "\n"
+            << "{\n"
+            << "public:\n"
+            << "    using TCustomWidgetCreator = std::function<QWidget*(const QString& type, const QJsonObject& item)>;\n"
+            << "\n"
+            << "    tt::TabToolbar* tabToolbar;\n";
+        for(const QString& declaration : declarations)
+            out << "    " << declaration << "\n";
+        out << "\n"
+            << "    template<class TActions>\n"
+            << "    tt::TabToolbar* setupTabToolbar(QWidget* parent, TActions* actions,\n"
+            << "                                    const TCustomWidgetCreator& createCustomWidget = TCustomWidgetCreator())\n"
+            << "    {\n"
+            << "        (void)actions;\n"
+            << "        (void)createCustomWidget;\n";
+        for(const QString& line : body)
+            out << "        " << line << "\n";
+        out << "        return tabToolbar;\n"
+            << "    }\n"
+            << "\n"
+            << "private:\n"
+            << "    static QWidget* createCustom(const TCustomWidgetCreator& creator, const QString& type, const QJsonObject& item)\n"
+            << "    {\n"
+            << "        QWidget* widget = (creator ? creator(type, item) : nullptr);\n"
+            << "        if(!widget)\n"
+            << "            throw std::logic_error(std::string(\"Unknown item type: \") + type.toStdString());\n"
+            << "        return widget;\n"
+            << "    }\n"
+            << "};\n"
+            << "\n"
+            << "namespace TT\n"
+            << "{\n"
+            << "    class " << className << " : public TT_" << className << " {};\n"
+            << "}\n"
+            << "\n"
+            << "#endif\n";
+    }
+
+private:
+    void GenerateGroup(const QString& page, const tt::GroupConfig& groupConfig)
+    {
+        const QString group = Assign("tt::Group*", groupConfig.name, "group");
+        Line(group + " = " + page + "->AddGroup(" + Literal(groupConfig.displayName) + ");");
+
+        for(const tt::ItemConfig& item : groupConfig.content)
+        {
+            switch(item.type)
+            {
+                case tt::ItemConfig::Type::Action:
+                    Line(Name(group) + "->AddAction(" + ActionArguments(item.action) + ");");
+                    break;
+                case tt::ItemConfig::Type::SubGroup:
+                    GenerateSubGroup(Name(group), item);
+                    break;
+                case tt::ItemConfig::Type::Separator:
+                    Line(Name(group) + "->AddSeparator();");
+                    break;
+                case tt::ItemConfig::Type::Custom:
+                    Line(Name(group) + "->AddWidget(" + CustomWidget(item) + ");");
+                    break;
+                default:
+                    throw ConfigError("horizontal actions must be placed inside subgroup");
+            }
+        }
+    }
+
+    void GenerateSubGroup(const QString& group, const tt::ItemConfig& item)
+    {
+        const QString subGroup = Assign("tt::SubGroup*", item.name, "subGroup");
+        Line(subGroup + " = " + group + "->AddSubGroup(" +
+             (item.aligned ? "tt::SubGroup::Align::Yes" : "tt::SubGroup::Align::No") + ");");
+        Line(Name(subGroup) + "->setObjectName(" + Literal(item.name) + ");");
+
+        for(const tt::ItemConfig& sgItem : item.content)
+        {
+            switch(sgItem.type)
+            {
+                case tt::ItemConfig::Type::Action:
+                    Line(Name(subGroup) + "->AddAction(" + ActionArguments(sgItem.action) + ");");
+                    break;
+                case tt::ItemConfig::Type::HorizontalActions:
+                {
+                    QStringList params;
+                    for(const tt::ActionConfig& action : sgItem.actions)
+                        params << "{" + PopupMode(action) + ", " + ActionRef(action.name) + ", " + MenuArgument(action, "nullptr") + "}";
+                    Line(Name(subGroup) + "->AddHorizontalButtons({" + params.join(", ") + "});");
+                    break;
+                }
+                case tt::ItemConfig::Type::Custom:
+                    Line(Name(subGroup) + "->AddWidget(" + CustomWidget(sgItem) + ");");
+                    break;
+                default:
+                    throw ConfigError("subgroups may contain only actions and custom widgets");
+            }
+        }
+    }
+
+    QString CustomWidget(const tt::ItemConfig& item)
+    {
+        if(item.customType.isEmpty())
+            throw ConfigError("item without \"itemType\"");
+
+        const QString widget = Assign("QWidget*", item.name, "widget");
+        Line(widget + " = createCustom(createCustomWidget, " + Literal(item.customType) + ", " + JsonObject(item.properties) + ");");
+        if(!item.name.isEmpty())
+            Line(Name(widget) + "->setObjectName(" + Literal(item.name) + ");");
+        return Name(widget);
+    }
+
+    QString ActionArguments(const tt::ActionConfig& action) const
+    {
+        QString arguments = PopupMode(action) + ", " + ActionRef(action.name);
+        const QString menu = MenuArgument(action, QString());
+        if(!menu.isEmpty())
+            arguments += ", " + menu;
+        return arguments;
+    }
+
+    static QString PopupMode(const tt::ActionConfig& action)
+    {
+        switch(action.type)
+        {
+            case QToolButton::DelayedPopup:
+                return "QToolButton::DelayedPopup";
+            case QToolButton::InstantPopup:
+                return "QToolButton::InstantPopup";
+            case QToolButton::MenuButtonPopup:
+                return "QToolButton::MenuButtonPopup";
+        }
+        throw ConfigError("unknown toolbutton popup mode");
+    }
+
+    QString MenuArgument(const tt::ActionConfig& action, const QString& none) const
+    {
+        if(action.menu.isEmpty())
+            return none;
+        if(configMenus.contains(action.menu))
+            return configMenus[action.menu];
+        return "actions->" + ValidMember(action.menu, "menu");
+    }
+
+    QString ActionRef(const QString& name) const
+    {
+        return "actions->" + ValidMember(name, "action");
+    }
+
+    static QString ValidMember(const QString& name, const char* kind)
+    {
+        static const QRegExp identifier("[A-Za-z_][A-Za-z0-9_]*");
+        if(!identifier.exactMatch(name))
+            throw ConfigError(QString("%1 name \"%2\" is not a valid C++ identifier").arg(kind).arg(name));
+        return name;
+    }
+
+    //declares class member for named widgets, local variable otherwise;
+    //returns left hand side of first assignment
+    QString Assign(const QString& type, const QString& name, const QString& localHint)
+    {
+        if(name.isEmpty())
+            return type + " " + Identifier(localHint);
+        const QString member = Identifier(name);
+        declarations << type + " " + member + ";";
+        return member;
+    }
+
+    QString Member(const QString& type, const QString& name)
+    {
+        const QString member = Identifier(name.isEmpty() ? QString("menu") : name);
+        declarations << type + " " + member + ";";
+        return member;
+    }
+
+    static QString Name(const QString& assignTarget)
+    {
+        return assignTarget.section(' ', -1);
+    }
+
+    QString Identifier(const QString& name)
+    {
+        static const QSet<QString> keywords = {
+            "alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char",
+            "class", "const", "constexpr", "continue", "default", "delete", "do", "double", "else",
+            "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if",
+            "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "nullptr",
+            "operator", "or", "private", "protected", "public", "register", "return", "short",
+            "signed", "sizeof", "static", "struct", "switch", "template", "this", "throw", "true",
+            "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+            "volatile", "while", "signals", "slots", "emit"
+        };
+
+        QString id;
+        for(const QChar c : name)
+            id += ((c.isLetterOrNumber() && c.unicode() < 128) || c == '_') ? c : QChar('_');
+        if(id.isEmpty() || id.at(0).isDigit())
+            id.prepend('_');
+        if(keywords.contains(id))
+            id += '_';
+
+        QString unique = id;
+        for(int i=1; usedIdentifiers.contains(unique); i++)
+            unique = id + QString::number(i);
+        usedIdentifiers.insert(unique);
+        return unique;
+    }
+
+    static QString Literal(const QString& str)
+    {
+        const QByteArray utf8 = str.toUtf8();
+        QString escaped;
+        bool ascii = true;
+        for(const char ch : utf8)
+        {
+            const unsigned char c = static_cast<unsigned char>(ch);
+            if(c == '\\' || c == '"')
+            {
+                escaped += '\\';
+                escaped += QChar(c);
+            }
+            else if(c == '\n')
+                escaped += "\\n";
+            else if(c < 32 || c >= 127)
+            {
+                escaped += QString("\\%1").arg(int(c), 3, 8, QChar('0'));
+                ascii = ascii && c < 127;
+            }
+            else
+                escaped += QChar(c);
+        }
+        if(ascii)
+            return "QStringLiteral(\"" + escaped + "\")";
+        return "QString::fromUtf8(\"" + escaped + "\")";
+    }
+
+    static QString JsonValue(const QJsonValue& value)
+    {
+        switch(value.type())
+        {
+            case QJsonValue::Bool:
+                return QString("QJsonValue(%1)").arg(value.toBool() ? "true" : "false");
+            case QJsonValue::Double:
+                return QString("QJsonValue(%1)").arg(QString::number(value.toDouble(), 'g', 17));
+            case QJsonValue::String:
+                return "QJsonValue(" + Literal(value.toString()) + ")";
+            case QJsonValue::Array:
+            {
+                QStringList values;
+                const QJsonArray array = value.toArray();
+                for(int i=0; i<array.size(); i++)
+                    values << JsonValue(array.at(i));
+                return "QJsonValue(QJsonArray{" + values.join(", ") + "})";
+            }
+            case QJsonValue::Object:
+                return "QJsonValue(" + JsonObject(value.toObject()) + ")";
+            default:
+                return "QJsonValue()";
+        }
+    }
+
+    static QString JsonObject(const QJsonObject& obj)
+    {
+        QStringList pairs;
+        for(auto it = obj.constBegin(); it != obj.constEnd(); ++it)
+            pairs << "{" + Literal(it.key()) + ", " + JsonValue(it.value()) + "}";
+        return "QJsonObject{" + pairs.join(", ") + "}";
+    }
+
+    void Line(const QString& code)
+    {
+        body << code;
+    }
+
+    const QString          className;
+    QStringList            declarations;
+    QStringList            body;
+    QSet<QString>          usedIdentifiers;
+    QMap<QString, QString> configMenus;
+};
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ttc");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TabToolbar config compiler");
+    parser.addHelpOption();
+    parser.addPositionalArgument("config", "TabToolbar json config to compile.");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "Place the output into <file>.", "file");
+    const QCommandLineOption nameOption(QStringList() << "n" << "name", "Name of generated class, defaults to config name.", "name");
+    const QCommandLineOption binaryOption(QStringList() << "b" << "binary", "Write binary config instead of C++ header.");
+    const QCommandLineOption jsonOption(QStringList() << "j" << "json", "Write json config instead of C++ header.");
+    parser.addOption(outputOption);
+    parser.addOption(nameOption);
+    parser.addOption(binaryOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if(args.size() != 1)
+        parser.showHelp(1);
+
+    const QString configPath = args.at(0);
+    QFile configFile(configPath);
+    if(!configFile.open(QIODevice::ReadOnly))
+    {
+        fprintf(stderr, "ttc: could not open %s\n", qPrintable(configPath));
+        return 1;
+    }
+    const QByteArray configData = configFile.readAll();
+    const uchar* data = reinterpret_cast<const uchar*>(configData.constData());
+
+    const QFileInfo configInfo(configPath);
+    QString className = parser.value(nameOption);
+    if(className.isEmpty())
+    {
+        for(const QChar c : configInfo.completeBaseName())
+            className += ((c.isLetterOrNumber() && c.unicode() < 128) || c == '_') ? c : QChar('_');
+    }
+
+    tt::ToolbarConfig config;
+    Generator generator(className);
+    try
+    {
+        if(tt::IsBinaryConfig(data, configData.size()))
+        {
+            config = tt::ParseBinaryConfig(data, configData.size());
+        }
+        else
+        {
+            QJsonParseError parseError;
+            const QJsonDocument json(QJsonDocument::fromJson(configData, &parseError));
+            if(parseError.error != QJsonParseError::NoError)
+                throw ConfigError(QString("json error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString()));
+            config = tt::ParseConfig(json.object());
+        }
+        if(!parser.isSet(binaryOption) && !parser.isSet(jsonOption))
+            generator.Generate(config);
+    }
+    catch(const std::exception& e)
+    {
+        fprintf(stderr, "%s: error: %s\n", qPrintable(configPath), e.what());
+        return 1;
+    }
+
+    QFile outFile;
+    const QIODevice::OpenMode mode = (parser.isSet(binaryOption) ? QIODevice::WriteOnly : QIODevice::WriteOnly | QIODevice::Text);
+    if(parser.isSet(outputOption))
+    {
+        outFile.setFileName(parser.value(outputOption));
+        if(!outFile.open(mode))
+        {
+            fprintf(stderr, "ttc: could not create output file %s\n", qPrintable(outFile.fileName()));
+            return 1;
+        }
+    }
+    else
+    {
+        outFile.open(stdout, mode);
+    }
+
+    if(parser.isSet(binaryOption))
+    {
+        outFile.write(tt::ConfigToBinary(config));
+    }
+    else if(parser.isSet(jsonOption))
+    {
+        outFile.write(QJsonDocument(tt::ConfigToJson(config)).toJson());
+    }
+    else
+    {
+        QTextStream out(&outFile);
+        out.setCodec("UTF-8");
+        generator.Write(out, configInfo.fileName());
+    }
+    return 0;
+}
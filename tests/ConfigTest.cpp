@@ -0,0 +1,111 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+#include <TabToolbar/ToolbarConfig.h>
+#include "ConfigTest.h"
+#include "TestConfigs.h"
+
+using namespace tt;
+
+namespace
+{
+const char* const g_popupModesConfig = R"({
+    "groupHeight": 75,
+    "groupRowCount": 3,
+    "tabs": [{
+        "name": "Home",
+        "displayName": "Home",
+        "groups": [{
+            "name": "Actions",
+            "displayName": "Actions",
+            "content": [
+                {"itemType": "action", "type": "delayedPopup", "name": "delayed"},
+                {"itemType": "action", "type": "instantPopup", "name": "instant", "menu": "menu"},
+                {"itemType": "action", "type": "menuButtonPopup", "name": "menuButton", "menu": "menu"},
+                {"itemType": "subgroup", "name": "rows", "aligned": true, "content": [
+                    {"itemType": "action", "type": "instantPopup", "name": "smallInstant"},
+                    {"itemType": "horizontalActions", "actions": [
+                        {"type": "delayedPopup", "name": "h1"},
+                        {"type": "instantPopup", "name": "h2"},
+                        {"type": "menuButtonPopup", "name": "h3"}
+                    ]}
+                ]}
+            ]
+        }]
+    }]
+})";
+
+ToolbarConfig BinaryRoundTrip(const ToolbarConfig& config)
+{
+    const QByteArray binary = ConfigToBinary(config);
+    return ParseBinaryConfig(reinterpret_cast<const uchar*>(binary.constData()), binary.size());
+}
+}
+
+void ConfigTest::BinaryRoundTripPopupModes()
+{
+    const ToolbarConfig config = ParseConfig(QJsonDocument::fromJson(g_popupModesConfig).object());
+    const ToolbarConfig restored = BinaryRoundTrip(config);
+    QCOMPARE(ConfigToJson(restored), ConfigToJson(config));
+
+    const QVector<ItemConfig>& items = restored.tabs.at(0).groups.at(0).content;
+    QCOMPARE(items.at(0).action.type, QToolButton::DelayedPopup);
+    QCOMPARE(items.at(1).action.type, QToolButton::InstantPopup);
+    QCOMPARE(items.at(2).action.type, QToolButton::MenuButtonPopup);
+    const QVector<ActionConfig>& horizontal = items.at(3).content.at(1).actions;
+    QCOMPARE(horizontal.at(0).type, QToolButton::DelayedPopup);
+    QCOMPARE(horizontal.at(1).type, QToolButton::InstantPopup);
+    QCOMPARE(horizontal.at(2).type, QToolButton::MenuButtonPopup);
+}
+
+void ConfigTest::BinaryRoundTripExample()
+{
+    QFile file(TT_EXAMPLE_CONFIG);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const ToolbarConfig config = ParseConfig(QJsonDocument::fromJson(file.readAll()).object());
+    QCOMPARE(ConfigToJson(BinaryRoundTrip(config)), ConfigToJson(config));
+}
+
+void ConfigTest::ParseJsonVsBinary_data()
+{
+    QTest::addColumn<bool>("binary");
+    QTest::newRow("json") << false;
+    QTest::newRow("binary") << true;
+}
+
+void ConfigTest::ParseJsonVsBinary()
+{
+    QFETCH(bool, binary);
+
+    const ToolbarConfig config = GenerateConfig(10, 10);
+    const QByteArray json = QJsonDocument(ConfigToJson(config)).toJson();
+    const QByteArray data = ConfigToBinary(config);
+
+    ToolbarConfig parsed;
+    QBENCHMARK
+    {
+        if(binary)
+            parsed = ParseBinaryConfig(reinterpret_cast<const uchar*>(data.constData()), data.size());
+        else
+            parsed = ParseConfig(QJsonDocument::fromJson(json).object());
+    }
+    QCOMPARE(parsed.tabs.size(), config.tabs.size());
+}
@@ -0,0 +1,121 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QFile>
+#include <QMetaProperty>
+#include <QtTest>
+#include <stdexcept>
+#include <TabToolbar/Styles.h>
+#include <TabToolbar/StyleTools.h>
+#include "StyleTest.h"
+
+using namespace tt;
+
+namespace
+{
+QString FormatColor(const QColor& col)
+{
+    return QString("rgba(%1, %2, %3, %4)").arg(col.red()).arg(col.green()).arg(col.blue()).arg(col.alpha());
+}
+
+QString FormatColor(const Colors& colors)
+{
+    if(colors.size() == 1)
+        return FormatColor(colors[0].value);
+
+    QString result = "qlineargradient(x1:0, y1:1, x2:0, y2:0";
+    for(std::size_t i=0; i<colors.size(); i++)
+        result += QString(", stop:") + QString::number(colors[i].coefficient) + " " + FormatColor(colors[i].value);
+    result += ")";
+    return result;
+}
+
+//reference copy of the renderer template one replaced: every property rescans the whole sheet
+QString LegacyFillStyle(const StyleParams& params)
+{
+    static const QString styleTemplate = []
+    {
+        QFile f(":/tt/StyleTemplate.qss");
+        f.open(QFile::ReadOnly);
+        return QString(f.readAll());
+    }();
+
+    QString style;
+    if(params.UseTemplateSheet)
+        style = styleTemplate;
+    style += params.AdditionalStyleSheet;
+
+    const int numProps = params.metaObject()->propertyCount();
+    for(int i=0; i<numProps; i++)
+    {
+        const QMetaProperty prop = params.metaObject()->property(i);
+        if(QString(prop.name()) == "objectName" || prop.type() == QVariant::Bool)
+            continue;
+        const QString propStr = QString("%") + prop.name() + "%";
+        if(!style.contains(propStr))
+            continue;
+        style.replace(propStr, "%1");
+
+        const QVariant property = params.property(prop.name());
+        switch(prop.type())
+        {
+            case QVariant::String:
+                style = style.arg(property.toString() + "px");
+                break;
+            case QVariant::Int:
+                style = style.arg(property.toInt());
+                break;
+            case QVariant::UserType:
+                style = style.arg(FormatColor(property.value<Colors>()));
+                break;
+            default:
+                throw std::runtime_error("Unknown property type in style!");
+        }
+    }
+    return style;
+}
+}
+
+void StyleTest::TemplateMatchesLegacyRenderer()
+{
+    for(const QString& styleName : GetRegisteredStyles())
+    {
+        const std::unique_ptr<StyleParams> params = CreateStyle(styleName);
+        QCOMPARE(GetSheetForStyle(*params), LegacyFillStyle(*params));
+    }
+}
+
+void StyleTest::RenderTemplateVsLegacy_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("template") << false;
+    QTest::newRow("legacy") << true;
+}
+
+// template is read once in both cases, so that only rendering is compared
+void StyleTest::RenderTemplateVsLegacy()
+{
+    QFETCH(bool, legacy);
+
+    const std::unique_ptr<StyleParams> params = CreateStyle(GetDefaultStyle());
+    QString sheet = GetSheetForStyle(*params);
+    QBENCHMARK
+    {
+        sheet = legacy ? LegacyFillStyle(*params) : GetSheetForStyle(*params);
+    }
+    QVERIFY(!sheet.isEmpty());
+}
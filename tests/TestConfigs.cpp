@@ -0,0 +1,90 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QAction>
+#include <QMenu>
+#include <QWidget>
+#include "TestConfigs.h"
+
+using namespace tt;
+
+namespace
+{
+ItemConfig ActionItem(QToolButton::ToolButtonPopupMode type, const QString& name, const QString& menu = QString())
+{
+    ItemConfig item;
+    item.type = ItemConfig::Type::Action;
+    item.action.type = type;
+    item.action.name = name;
+    item.action.menu = menu;
+    return item;
+}
+}
+
+ToolbarConfig GenerateConfig(int tabs, int groupsPerTab)
+{
+    ToolbarConfig config;
+    config.groupHeight = 75;
+    config.groupRowCount = 3;
+    config.menus.append({"menu", {"large", "separator", "small"}});
+
+    for(int t=0; t<tabs; t++)
+    {
+        TabConfig tab;
+        tab.name = tab.displayName = QString("Tab %1").arg(t);
+        for(int g=0; g<groupsPerTab; g++)
+        {
+            GroupConfig group;
+            group.name = group.displayName = QString("Group %1.%2").arg(t).arg(g);
+            group.content.append(ActionItem(QToolButton::DelayedPopup, "large"));
+            group.content.append(ActionItem(QToolButton::MenuButtonPopup, "menuButton", "menu"));
+            group.content.append(ItemConfig());
+
+            ItemConfig subGroup;
+            subGroup.type = ItemConfig::Type::SubGroup;
+            subGroup.name = QString("Rows %1.%2").arg(t).arg(g);
+            subGroup.aligned = true;
+            subGroup.content.append(ActionItem(QToolButton::DelayedPopup, "small"));
+            subGroup.content.append(ActionItem(QToolButton::InstantPopup, "large", "menu"));
+            ItemConfig horizontal;
+            horizontal.type = ItemConfig::Type::HorizontalActions;
+            horizontal.actions.append(ActionItem(QToolButton::DelayedPopup, "small").action);
+            horizontal.actions.append(ActionItem(QToolButton::MenuButtonPopup, "large", "menu").action);
+            subGroup.content.append(horizontal);
+            group.content.append(subGroup);
+
+            tab.groups.append(group);
+        }
+        config.tabs.append(tab);
+    }
+    return config;
+}
+
+ActionRegistry GenerateActions(QWidget* parent)
+{
+    ActionRegistry registry;
+    for(const char* name : {"large", "menuButton", "small"})
+    {
+        QAction* action = new QAction(name, parent);
+        action->setObjectName(name);
+        registry.AddAction(action);
+    }
+    QMenu* menu = new QMenu(parent);
+    menu->setObjectName("menu");
+    registry.AddMenu(menu);
+    return registry;
+}
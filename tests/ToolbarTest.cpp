@@ -0,0 +1,157 @@
+/*
+    TabToolbar - a small utility library for Qt, providing tabbed toolbars
+	Copyright (C) 2018 Oleksii Sierov
+	
+    TabToolbar is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    TabToolbar is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TabToolbar.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <QApplication>
+#include <QLineEdit>
+#include <QSet>
+#include <QStyle>
+#include <QToolButton>
+#include <QVBoxLayout>
+#include <QWidget>
+#include <QtTest>
+#include <memory>
+#include <vector>
+#include <TabToolbar/Builder.h>
+#include <TabToolbar/TabToolbar.h>
+#include <TabToolbar/ToolbarContext.h>
+#include "TestConfigs.h"
+#include "ToolbarTest.h"
+
+using namespace tt;
+
+namespace
+{
+int CountWidgets(const ActionRegistry& registry, QWidget* parent, bool painted)
+{
+    ToolbarConfig config = GenerateConfig(5, 10);
+    config.paintedButtons = painted;
+    Builder builder(parent, registry);
+    std::unique_ptr<TabToolbar> tt(builder.CreateTabToolbar(config));
+    return tt->findChildren<QWidget*>().size();
+}
+
+int CountLive(const std::vector<std::weak_ptr<TTToolButtonStyle>>& styles)
+{
+    int count = 0;
+    for(const auto& style : styles)
+        count += style.expired() ? 0 : 1;
+    return count;
+}
+}
+
+void ToolbarTest::ButtonStyleSharedAcrossCycles()
+{
+    QWidget window;
+    const ActionRegistry registry = GenerateActions(&window);
+    const ToolbarConfig config = GenerateConfig(3, 4);
+
+    std::vector<std::weak_ptr<TTToolButtonStyle>> styles;
+    for(int cycle=0; cycle<10; cycle++)
+    {
+        Builder builder(&window, registry);
+        TabToolbar* first = builder.CreateTabToolbar(config);
+        TabToolbar* second = builder.CreateTabToolbar(config);
+        QVERIFY(first->Context()->buttonStyle == second->Context()->buttonStyle);
+        styles.push_back(first->Context()->buttonStyle);
+
+        // large buttons use the shared style instead of owning one each
+        QSet<QStyle*> buttonStyles;
+        for(QToolButton* button : first->findChildren<QToolButton*>())
+            if(button->property("TTIconMetric").toInt() == QStyle::PM_LargeIconSize)
+                buttonStyles.insert(button->style());
+        QCOMPARE(buttonStyles.size(), 1);
+
+        delete first;
+        QCOMPARE(CountLive(styles), 1);
+        delete second;
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QCOMPARE(CountLive(styles), 0);
+    }
+}
+
+void ToolbarTest::FocusChurn_data()
+{
+    QTest::addColumn<int>("toolbars");
+    QTest::addColumn<bool>("minimized");
+    QTest::newRow("1 toolbar") << 1 << false;
+    QTest::newRow("10 toolbars") << 10 << false;
+    QTest::newRow("50 toolbars") << 50 << false;
+    QTest::newRow("50 minimized toolbars") << 50 << true;
+}
+
+// focus moving between editors must not cost anything per toolbar unless one of them peeks a page
+void ToolbarTest::FocusChurn()
+{
+    QFETCH(int, toolbars);
+    QFETCH(bool, minimized);
+
+    QWidget window;
+    QVBoxLayout* layout = new QVBoxLayout(&window);
+    for(int i=0; i<toolbars; i++)
+    {
+        TabToolbar* tt = new TabToolbar(&window);
+        tt->AddPage("Home");
+        if(minimized)
+            tt->HideAction()->trigger();
+        layout->addWidget(tt);
+    }
+    QLineEdit* first = new QLineEdit(&window);
+    QLineEdit* second = new QLineEdit(&window);
+    layout->addWidget(first);
+    layout->addWidget(second);
+    window.show();
+    QApplication::setActiveWindow(&window);
+
+    QBENCHMARK
+    {
+        for(int i=0; i<100; i++)
+            (i % 2 ? second : first)->setFocus();
+    }
+    QCOMPARE(QApplication::focusWidget(), static_cast<QWidget*>(second));
+}
+
+void ToolbarTest::PaintedButtonsWidgetCount()
+{
+    QWidget window;
+    const ActionRegistry registry = GenerateActions(&window);
+    const int widgets = CountWidgets(registry, &window, false);
+    const int painted = CountWidgets(registry, &window, true);
+    QVERIFY2(painted * 3 < widgets * 2, qPrintable(QString("%1 widgets painted, %2 otherwise").arg(painted).arg(widgets)));
+}
+
+void ToolbarTest::BuildPaintedVsWidgets_data()
+{
+    QTest::addColumn<bool>("painted");
+    QTest::newRow("widgets") << false;
+    QTest::newRow("painted") << true;
+}
+
+void ToolbarTest::BuildPaintedVsWidgets()
+{
+    QFETCH(bool, painted);
+
+    QWidget window;
+    const ActionRegistry registry = GenerateActions(&window);
+    ToolbarConfig config = GenerateConfig(5, 10);
+    config.paintedButtons = painted;
+
+    QBENCHMARK
+    {
+        Builder builder(&window, registry);
+        delete builder.CreateTabToolbar(config);
+    }
+}